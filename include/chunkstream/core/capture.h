@@ -0,0 +1,95 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_CAPTURE_H_
+#define CHUNKSTREAM_CORE_CAPTURE_H_
+
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chunkstream {
+
+// Writes datagrams with their arrival times to a pcap file with nanosecond timestamps.
+// Each record carries a synthesized IPv4 or IPv6 and UDP header (LINKTYPE_RAW), so captures
+// open in Wireshark and tcpdump as well as in `chunkstream_replay`. `Write()` may be called
+// from several threads; records are buffered and reach the file on `Flush()` or destruction.
+class CaptureWriter {
+public:
+  // @param snap_length Bytes kept of each datagram, e.g. CHUNKHEADER_SIZE for headers only; 0 keeps them whole
+  explicit CaptureWriter(const std::string& path, const size_t snap_length = 0);
+  CaptureWriter(const CaptureWriter&) = delete;
+  CaptureWriter& operator=(const CaptureWriter&) = delete;
+  ~CaptureWriter();
+
+  // @return false if the file could not be created or a write failed
+  bool IsOpen() const;
+
+  void Write(const std::chrono::system_clock::time_point arrival,
+             const asio::ip::udp::endpoint& source,
+             const asio::ip::udp::endpoint& destination,
+             const uint8_t* data,
+             const size_t size);
+
+  void Flush();
+
+  uint64_t GetPacketCount() const;
+
+public:
+  const size_t SNAP_LENGTH;
+
+private:
+  mutable std::mutex mutex_;
+  std::unique_ptr<char[]> file_buffer_;
+  std::ofstream file_;
+  std::vector<uint8_t> record_;  // Scratch of `Write()`
+  uint64_t packet_count_ = 0;
+};
+
+// Reads UDP datagrams from a pcap file written by `CaptureWriter`, or by tcpdump on
+// Ethernet, Linux cooked (`-i any`) or raw IP links, in microsecond or nanosecond resolution.
+// Records which are not UDP, are IP fragments or are cut short by the snap length are skipped.
+class CaptureReader {
+public:
+  struct Packet {
+    std::chrono::system_clock::time_point arrival;
+    asio::ip::udp::endpoint source;
+    asio::ip::udp::endpoint destination;
+    std::vector<uint8_t> data;
+  };
+
+public:
+  explicit CaptureReader(const std::string& path);
+
+  // @return false if the file could not be opened or is not a pcap file of a supported link type
+  bool IsOpen() const;
+
+  // @return false at the end of the file
+  bool Next(Packet* packet);
+
+  uint64_t GetSkippedCount() const;
+
+private:
+  // @return false if the record is not a whole UDP datagram
+  bool __Parse(const uint8_t* record, const size_t size, Packet* packet) const;
+
+  uint32_t __Read32(const uint8_t* data) const;
+
+private:
+  std::ifstream file_;
+  bool open_ = false;
+  bool swapped_ = false;     // File written with the other byte order
+  bool nanoseconds_ = false;
+  uint32_t link_type_ = 0;
+  std::vector<uint8_t> record_;
+  uint64_t skipped_count_ = 0;
+};
+
+}
+
+#endif
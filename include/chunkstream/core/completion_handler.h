@@ -0,0 +1,72 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_COMPLETION_HANDLER_H_
+#define CHUNKSTREAM_CORE_COMPLETION_HANDLER_H_
+
+#include <asio.hpp>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace chunkstream {
+
+// Move-only, type-erased holder of an asio completion handler with signature `void(Args...)`.
+// Completing it posts the handler to its associated executor (e.g. the coroutine's executor
+// for `asio::use_awaitable`), which is kept from running out of work until then.
+// It is completed at most once; completing an empty holder does nothing.
+template<typename... Args>
+class CompletionHandler {
+public:
+  CompletionHandler() = default;
+
+  template<typename Handler>
+  explicit CompletionHandler(Handler handler)
+    : impl_(std::make_unique<Impl<Handler>>(std::move(handler))) {}
+
+  CompletionHandler(CompletionHandler&&) = default;
+  CompletionHandler& operator=(CompletionHandler&&) = default;
+
+  void operator()(Args... args) {
+    if (!impl_) return;
+    std::unique_ptr<Base> impl = std::move(impl_);
+    impl->Complete(std::move(args)...);
+  }
+
+  explicit operator bool() const {
+    return impl_ != nullptr;
+  }
+
+private:
+  class Base {
+  public:
+    virtual ~Base() = default;
+    virtual void Complete(Args... args) = 0;
+  };
+
+  template<typename Handler>
+  class Impl : public Base {
+  public:
+    explicit Impl(Handler handler)
+      : work_(asio::make_work_guard(asio::get_associated_executor(handler))),
+        handler_(std::move(handler)) {}
+
+    void Complete(Args... args) override {
+      asio::post(work_.get_executor(),
+        [handler = std::move(handler_), args = std::make_tuple(std::move(args)...)]() mutable {
+          std::apply(std::move(handler), std::move(args));
+        });
+      work_.reset();
+    }
+
+  private:
+    asio::executor_work_guard<asio::associated_executor_t<Handler>> work_;
+    Handler handler_;
+  };
+
+  std::unique_ptr<Base> impl_;
+};
+
+}
+
+#endif
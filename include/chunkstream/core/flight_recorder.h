@@ -0,0 +1,155 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_FLIGHT_RECORDER_H_
+#define CHUNKSTREAM_CORE_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace chunkstream {
+
+// @return CPU timestamp counter, or steady clock nanoseconds where there is none
+inline uint64_t ReadTimestampCounter() {
+#if defined(__x86_64__) || defined(__i386__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Fixed-size ring of compact per-frame events, overwritten oldest first, for explaining
+// individual slow or dropped frames after the fact. `Record()` is lock-free and
+// may be called from several threads. Dumps are read by the `chunkstream_timeline` tool.
+class FlightRecorder {
+public:
+  enum EventType {
+    FRAME_CREATED,  // arg: total chunks
+    FIRST_CHUNK,    // arg: chunk index
+    LAST_CHUNK,     // arg: chunk index
+    RESEND_ROUND,   // arg: round, starting from 1
+    FRAME_READY,
+    FRAME_GRABBED,  // Handed to the handler
+    FRAME_RELEASED,
+    FRAME_DROPPED   // arg: 0 timed out, 1 abandoned
+  };
+
+  struct Event {
+    uint64_t tsc;
+    uint32_t frame_id;
+    uint16_t arg;
+    uint8_t type;
+    uint8_t stream;   // Set per receiver, to tell streams sharing a recorder apart
+  };
+
+  // Beginning of a dump file, followed by `event_count` events, oldest first; native byte order
+  struct FileHeader {
+    char magic[4];    // "CSFR"
+    uint32_t version;
+    uint64_t event_count;
+    double ticks_per_second;
+    int64_t dump_time_ns;  // System clock at the dump, since the epoch
+    uint64_t dump_tsc;
+  };
+
+public:
+  // @param capacity Number of events kept; rounded up to a power of two
+  explicit FlightRecorder(const size_t capacity = 65536);
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+  ~FlightRecorder();
+
+  void Record(const EventType type, const uint32_t frame_id, const uint16_t arg, const uint8_t stream) {
+    const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index & MASK];
+    // Per-slot seqlock: odd while being written
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.tsc.store(ReadTimestampCounter(), std::memory_order_relaxed);
+    slot.payload.store(__Pack(type, frame_id, arg, stream), std::memory_order_relaxed);
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+    if (type == FRAME_DROPPED) {
+      __CountDrop();
+    }
+  }
+
+  // @return Events still in the ring, oldest first; slots being overwritten are skipped
+  std::vector<Event> Snapshot() const;
+
+  // Writes a `FileHeader` and `Snapshot()` to `path`.
+  bool Dump(const std::string& path) const;
+
+  // Dumps to `path.1`, `path.2`, ... from a background thread when `drops` frames are dropped
+  // within `window`, at most once per window. 0 drops disables it. Counting drops takes no lock.
+  void DumpOnDropSpike(const std::string& path, const size_t drops, const std::chrono::milliseconds window);
+
+  static bool Load(const std::string& path, FileHeader* header, std::vector<Event>* events);
+
+public:
+  const size_t CAPACITY;
+  const uint64_t MASK;
+
+  static constexpr uint32_t FILE_VERSION = 1;
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> tsc{0};
+    std::atomic<uint64_t> payload{0};
+  };
+
+  static uint64_t __Pack(const EventType type, const uint32_t frame_id,
+                         const uint16_t arg, const uint8_t stream) {
+    return static_cast<uint64_t>(frame_id)
+           | static_cast<uint64_t>(arg) << 32
+           | static_cast<uint64_t>(type) << 48
+           | static_cast<uint64_t>(stream) << 56;
+  }
+
+  void __CountDrop();
+  // Body of `spike_thread_`; writes the dumps requested by `__CountDrop()`
+  void __DumpSpikes();
+
+private:
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_ = 0;
+
+  // Reference points to convert timestamp counter ticks to time
+  const uint64_t start_tsc_;
+  const std::chrono::steady_clock::time_point start_time_;
+
+  // Read on every drop without a lock
+  std::atomic<size_t> spike_drops_ = 0;
+  std::atomic<int64_t> spike_window_ns_ = 0;
+  std::atomic<int64_t> window_start_ns_ = 0; // Since `start_time_`
+  std::atomic<size_t> window_drops_ = 0;
+
+  std::mutex spike_mutex_;
+  std::condition_variable spike_requested_;
+  std::string spike_path_;      // Guarded by `spike_mutex_`
+  size_t spike_requests_ = 0;   // Guarded by `spike_mutex_`
+  size_t spike_count_ = 0;      // Guarded by `spike_mutex_`
+  bool stopping_ = false;       // Guarded by `spike_mutex_`
+  std::thread spike_thread_;    // Started by the first `DumpOnDropSpike()`
+};
+
+}
+
+#endif
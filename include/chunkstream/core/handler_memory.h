@@ -0,0 +1,115 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_HANDLER_MEMORY_H_
+#define CHUNKSTREAM_CORE_HANDLER_MEMORY_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace chunkstream {
+
+// Fixed storage for the asynchronous operations of one object (e.g. its timers),
+// so that asio does not allocate from the heap for every wait.
+// Falls back to the heap if all slots are in use or the operation is too large.
+// Not thread-safe; operations must be started and completed on one thread or strand.
+template<size_t SLOT_SIZE, size_t SLOT_COUNT>
+class HandlerMemory {
+public:
+  HandlerMemory() = default;
+  HandlerMemory(const HandlerMemory&) = delete;
+  HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+  void* Allocate(const size_t size) {
+    if (size <= SLOT_SIZE) {
+      for (size_t i = 0; i < SLOT_COUNT; i++) {
+        if (!in_use_[i]) {
+          in_use_[i] = true;
+          return storage_[i];
+        }
+      }
+    }
+    return ::operator new(size);
+  }
+
+  void Deallocate(void* ptr) {
+    for (size_t i = 0; i < SLOT_COUNT; i++) {
+      if (ptr == storage_[i]) {
+        in_use_[i] = false;
+        return;
+      }
+    }
+    ::operator delete(ptr);
+  }
+
+private:
+  alignas(std::max_align_t) unsigned char storage_[SLOT_COUNT][SLOT_SIZE];
+  bool in_use_[SLOT_COUNT] = {};
+};
+
+// Allocator which asio picks up as the associated allocator of `AllocatedHandler`
+template<typename T, typename Memory>
+class HandlerAllocator {
+public:
+  using value_type = T;
+
+  explicit HandlerAllocator(Memory& memory) : memory_(&memory) {}
+
+  template<typename U>
+  HandlerAllocator(const HandlerAllocator<U, Memory>& other) noexcept : memory_(other.memory_) {}
+
+  T* allocate(const size_t n) {
+    return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+  }
+
+  void deallocate(T* ptr, const size_t) {
+    memory_->Deallocate(ptr);
+  }
+
+  template<typename U>
+  bool operator==(const HandlerAllocator<U, Memory>& other) const noexcept {
+    return memory_ == other.memory_;
+  }
+
+  template<typename U>
+  bool operator!=(const HandlerAllocator<U, Memory>& other) const noexcept {
+    return memory_ != other.memory_;
+  }
+
+private:
+  template<typename, typename> friend class HandlerAllocator;
+  Memory* memory_;
+};
+
+template<typename Handler, typename Memory>
+class AllocatedHandler {
+public:
+  using allocator_type = HandlerAllocator<Handler, Memory>;
+
+  AllocatedHandler(Memory& memory, Handler handler)
+    : memory_(memory), handler_(std::move(handler)) {}
+
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(memory_);
+  }
+
+  template<typename... Args>
+  void operator()(Args&&... args) {
+    handler_(std::forward<Args>(args)...);
+  }
+
+private:
+  Memory& memory_;
+  Handler handler_;
+};
+
+// Wraps `handler` so that asio allocates its operation from `memory`
+template<typename Memory, typename Handler>
+AllocatedHandler<Handler, Memory> MakeAllocatedHandler(Memory& memory, Handler handler) {
+  return AllocatedHandler<Handler, Memory>(memory, std::move(handler));
+}
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_HISTOGRAM_H_
+#define CHUNKSTREAM_CORE_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chunkstream {
+
+// Log-bucketed histogram in the style of HdrHistogram: each power of two is split into
+// SUB_BUCKET_COUNT linear buckets, so a value is known within 1/SUB_BUCKET_COUNT of itself
+// over the whole uint64_t range, in a fixed array and without allocating.
+// `Record()` is lock-free and may be called from several threads.
+class Histogram {
+public:
+  struct Bucket {
+    uint64_t upper_bound; // Largest value counted in the bucket
+    uint64_t count;
+  };
+
+public:
+  void Record(const uint64_t value);
+
+  uint64_t GetCount() const;
+  uint64_t GetSum() const;
+  uint64_t GetMax() const;
+
+  // @param percentile In [0, 100], e.g. 99.9
+  // @return Upper bound of the bucket holding the percentile, capped by `GetMax()`; 0 if empty
+  uint64_t GetPercentile(const double percentile) const;
+
+  // @return Non-empty buckets in increasing order
+  std::vector<Bucket> GetBuckets() const;
+
+public:
+  static constexpr size_t SUB_BUCKET_BITS = 4;
+  static constexpr size_t SUB_BUCKET_COUNT = size_t(1) << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+private:
+  static size_t __BucketIndex(const uint64_t value);
+  static uint64_t __UpperBound(const size_t index);
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_ = {};
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<uint64_t> sum_ = 0;
+  std::atomic<uint64_t> max_ = 0;
+};
+
+}
+
+#endif
@@ -7,51 +7,102 @@
 #include <unordered_map>
 #include <list>
 #include <mutex>
+#include <optional>
+#include <vector>
 
 namespace chunkstream {
 
+// Removed nodes are kept and reused by later insertions, so once the container
+// reached its working size (or `reserve()` was called) it does not allocate.
 template<typename Key, typename Value>
 class OrderedHashContainer {
 private:
-  std::list<std::pair<Key, Value>> ordered_data_;  
-  std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> key_to_iterator_;
+  using List = std::list<std::pair<Key, Value>>;
+  using Map = std::unordered_map<Key, typename List::iterator>;
+
+  List ordered_data_;
+  Map key_to_iterator_;
+  List free_list_nodes_;
+  std::vector<typename Map::node_type> free_map_nodes_;
   mutable std::mutex lock_;
-    
+
+  // Must be called with `lock_` held
+  typename List::iterator __AcquireListNode(const Key& key) {
+    if (free_list_nodes_.empty()) {
+      return ordered_data_.emplace(ordered_data_.end(), key, Value());
+    }
+    ordered_data_.splice(ordered_data_.end(), free_list_nodes_, free_list_nodes_.begin());
+    auto it = std::prev(ordered_data_.end());
+    it->first = key;
+    return it;
+  }
+
+  // Must be called with `lock_` held
+  void __Index(const Key& key, typename List::iterator it) {
+    if (free_map_nodes_.empty()) {
+      key_to_iterator_[key] = it;
+      return;
+    }
+    typename Map::node_type node = std::move(free_map_nodes_.back());
+    free_map_nodes_.pop_back();
+    node.key() = key;
+    node.mapped() = it;
+    auto result = key_to_iterator_.insert(std::move(node));
+    if (!result.inserted) {
+      result.position->second = it;
+      free_map_nodes_.push_back(std::move(result.node));
+    }
+  }
+
+  // Must be called with `lock_` held
+  void __Remove(typename Map::iterator map_it) {
+    auto list_it = map_it->second;
+    list_it->second = Value();
+    free_list_nodes_.splice(free_list_nodes_.end(), ordered_data_, list_it);
+    free_map_nodes_.push_back(key_to_iterator_.extract(map_it));
+  }
+
 public:
   std::pair<Key, Value>& operator[](const int i) {
     return *(ordered_data_.begin() + i);
   }
 
+  // Preallocates nodes for `n` elements
+  void reserve(const size_t n) {
+    std::lock_guard<std::mutex> lock(lock_);
+    key_to_iterator_.reserve(n);
+    free_map_nodes_.reserve(n);
+    for (size_t i = ordered_data_.size() + free_list_nodes_.size(); i < n; i++) {
+      free_list_nodes_.emplace_back();
+    }
+  }
+
   // O(1) insertion
   auto& push_back(const Key& key, const Value& value) {
     std::lock_guard<std::mutex> lock(lock_);
-    auto& ref = ordered_data_.emplace_back(key, value);
-    auto it = std::prev(ordered_data_.end());
-    key_to_iterator_[key] = it;
-    return ref;
+    auto it = __AcquireListNode(key);
+    it->second = value;
+    __Index(key, it);
+    return *it;
   }
 
   // O(1) insertion
   auto& push_back(const Key& key, Value&& value) {
     std::lock_guard<std::mutex> lock(lock_);
-    auto& ref = ordered_data_.emplace_back(key, std::move(value));
-    auto it = std::prev(ordered_data_.end());
-    key_to_iterator_[key] = it;
-    return ref;
+    auto it = __AcquireListNode(key);
+    it->second = std::move(value);
+    __Index(key, it);
+    return *it;
   }
-  
+
   // O(1) in-place construction
   template<typename... Args>
   auto& emplace_back(const Key& key, Args&&... args) {
     std::lock_guard<std::mutex> lock(lock_);
-    auto& ref = ordered_data_.emplace_back(
-      std::piecewise_construct,
-      std::forward_as_tuple(key),
-      std::forward_as_tuple(std::forward<Args>(args)...)
-    );
-    auto it = std::prev(ordered_data_.end());
-    key_to_iterator_[key] = it;
-    return ref;
+    auto it = __AcquireListNode(key);
+    it->second = Value(std::forward<Args>(args)...);
+    __Index(key, it);
+    return *it;
   }
 
   // O(1) front
@@ -59,13 +110,13 @@ public:
     std::lock_guard<std::mutex> lock(lock_);
     return ordered_data_.front();
   }
-  
+
   // O(1) back
   const std::pair<Key, Value>& back() const {
     std::lock_guard<std::mutex> lock(lock_);
     return ordered_data_.back();
   }
-  
+
   // O(1) ~ O(n) search
   Value* find(const Key& key) {
     std::lock_guard<std::mutex> lock(lock_);
@@ -75,23 +126,55 @@ public:
     }
     return nullptr;
   }
-  
+
   // O(1) pop
   void pop_front() {
     std::lock_guard<std::mutex> lock(lock_);
     if (!ordered_data_.empty()) {
-      key_to_iterator_.erase(ordered_data_.front().first);
-      ordered_data_.pop_front();
+      __Remove(key_to_iterator_.find(ordered_data_.front().first));
     }
   }
-  
-  // O(n) remove
+
+  // O(1) remove
   void erase(const Key& key) {
     std::lock_guard<std::mutex> lock(lock_);
     auto it = key_to_iterator_.find(key);
     if (it != key_to_iterator_.end()) {
-      ordered_data_.erase(it->second);
-      key_to_iterator_.erase(it);
+      __Remove(it);
+    }
+  }
+
+  // O(1) remove, returning the removed value
+  std::optional<Value> extract(const Key& key) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = key_to_iterator_.find(key);
+    if (it == key_to_iterator_.end()) {
+      return std::nullopt;
+    }
+    std::optional<Value> value(std::move(it->second->second));
+    __Remove(it);
+    return value;
+  }
+
+  // O(1) pop, returning the removed element
+  std::optional<std::pair<Key, Value>> extract_front() {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (ordered_data_.empty()) {
+      return std::nullopt;
+    }
+    auto it = key_to_iterator_.find(ordered_data_.front().first);
+    std::optional<std::pair<Key, Value>> element(std::move(ordered_data_.front()));
+    __Remove(it);
+    return element;
+  }
+
+  // Calls `function(key, value)` for each element in insertion order.
+  // `function` must not modify the container.
+  template<typename Function>
+  void for_each(Function function) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (std::pair<Key, Value>& element : ordered_data_) {
+      function(element.first, element.second);
     }
   }
 
@@ -108,4 +191,4 @@ public:
 
 }
 
-#endif
\ No newline at end of file
+#endif
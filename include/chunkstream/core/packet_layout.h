@@ -0,0 +1,77 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_PACKET_LAYOUT_H_
+#define CHUNKSTREAM_CORE_PACKET_LAYOUT_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include "chunkstream/core/chunk_header.h"
+
+namespace chunkstream {
+
+// IP header + UDP header
+const size_t IP_UDP_HEADER_SIZE = 20 + 8;
+
+// Packet layout derived from a MTU given at runtime.
+class DynamicLayout {
+public:
+  static constexpr size_t DEFAULT_MTU = 1500;
+
+  explicit DynamicLayout(const size_t mtu)
+    : MTU(mtu),
+      PACKET_SIZE(mtu - IP_UDP_HEADER_SIZE),
+      PAYLOAD(mtu - IP_UDP_HEADER_SIZE - CHUNKHEADER_SIZE) {}
+
+  size_t ChunkCount(const size_t size) const {
+    return (size + PAYLOAD - 1) / PAYLOAD;
+  }
+
+  size_t ChunkOffset(const size_t chunk_index) const {
+    return chunk_index * PAYLOAD;
+  }
+
+public:
+  const size_t MTU;
+  const size_t PACKET_SIZE; // mtu - IP header - UDP header
+  const size_t PAYLOAD;     // mtu - IP header - UDP header - Chunk header
+};
+
+// Packet layout fixed at compile time, so chunk offset/count math is done
+// with constants instead of runtime multiplications and divisions.
+template<size_t Mtu>
+class StaticLayout {
+public:
+  static constexpr size_t DEFAULT_MTU = Mtu;
+  static constexpr size_t MTU = Mtu;
+  static constexpr size_t PACKET_SIZE = Mtu - IP_UDP_HEADER_SIZE;
+  static constexpr size_t PAYLOAD = Mtu - IP_UDP_HEADER_SIZE - CHUNKHEADER_SIZE;
+
+  static_assert(Mtu > IP_UDP_HEADER_SIZE + CHUNKHEADER_SIZE, "MTU is too small to carry a chunk");
+
+  // @throw std::invalid_argument if `mtu` differs from the compile-time MTU.
+  explicit StaticLayout(const size_t mtu = Mtu) {
+    if (mtu != Mtu) {
+      throw std::invalid_argument(
+        "MTU " + std::to_string(mtu) + " does not match StaticLayout<" + std::to_string(Mtu) + ">"
+      );
+    }
+  }
+
+  static constexpr size_t ChunkCount(const size_t size) {
+    return (size + PAYLOAD - 1) / PAYLOAD;
+  }
+
+  static constexpr size_t ChunkOffset(const size_t chunk_index) {
+    return chunk_index * PAYLOAD;
+  }
+};
+
+// Common MTUs
+using Layout1500 = StaticLayout<1500>;
+using Layout9000 = StaticLayout<9000>;
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_PENDING_COUNT_H_
+#define CHUNKSTREAM_CORE_PENDING_COUNT_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace chunkstream {
+
+// Count of asynchronous handlers which are started but not finished yet,
+// which another thread can wait to reach zero.
+// The mutex is only taken when the count reaches zero, not on every handler.
+class PendingCount {
+public:
+  PendingCount() = default;
+  PendingCount(const PendingCount&) = delete;
+  PendingCount& operator=(const PendingCount&) = delete;
+
+  void Add() {
+    count_++;
+  }
+
+  // Wakes up `Wait()` if this was the last pending handler
+  void Done() {
+    if (--count_ == 0) {
+      // Between the check of `Wait()` and its sleep, the mutex is held
+      std::lock_guard<std::mutex> lock(mutex_);
+      idle_.notify_all();
+    }
+  }
+
+  // Blocks until no handler is pending
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return count_ == 0; });
+  }
+
+  size_t Get() const {
+    return count_;
+  }
+
+private:
+  std::atomic<size_t> count_ = 0;
+  std::mutex mutex_;
+  std::condition_variable idle_;
+};
+
+// Counts a handler as finished when it goes out of scope
+class PendingGuard {
+public:
+  explicit PendingGuard(PendingCount& pending) : pending_(pending) {}
+  ~PendingGuard() { pending_.Done(); }
+  PendingGuard(const PendingGuard&) = delete;
+  PendingGuard& operator=(const PendingGuard&) = delete;
+
+private:
+  PendingCount& pending_;
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_SIMULATED_LINK_H_
+#define CHUNKSTREAM_CORE_SIMULATED_LINK_H_
+
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace chunkstream {
+
+class SimulatedSocket;
+
+// In-memory datagram network between `SimulatedSocket`s, with configurable impairments,
+// to reproduce loss and resend behaviour on one machine without `tc netem` or root.
+// The fate of every datagram (loss, duplication, reordering, jitter) is drawn from a generator
+// seeded at construction, a fixed number of draws per datagram in the order they are sent,
+// so the same seed and send order give the same drop, reorder and duplicate decisions.
+// Delivery times are computed on the steady clock, and datagrams are delivered by a timer
+// on the link's strand; the bandwidth queue and the peers' resend timers depend on real time,
+// so a seed does not make a whole run repeatable. Its executor must keep running while
+// sockets are in use, and must have stopped running its handlers before the link is destroyed.
+class SimulatedLink {
+public:
+  struct Impairments {
+    double loss = 0;                         // Probability that a datagram is lost
+    // Gilbert-Elliott burst loss: a good and a bad state, stepped once per datagram
+    double burst_start = 0;                  // Probability of going from the good to the bad state
+    double burst_end = 1;                    // Probability of going from the bad to the good state
+    double burst_loss = 1;                   // Loss probability in the bad state
+    double reorder = 0;                      // Probability that a datagram is held back by `reorder_delay`
+    std::chrono::microseconds reorder_delay{500};
+    double duplicate = 0;                    // Probability that a datagram is delivered twice
+    std::chrono::microseconds delay{0};      // One-way delay
+    std::chrono::microseconds jitter{0};     // Uniform extra delay below it
+    uint64_t bandwidth = 0;                  // Bits per second, or 0 for no cap
+    size_t queue_size = 0;                   // Bytes waiting behind the bandwidth cap before tail drops, or 0 for no limit
+  };
+
+  struct Stats {
+    uint64_t datagrams_sent = 0;
+    uint64_t datagrams_delivered = 0;        // Including duplicates
+    uint64_t lost = 0;                       // By `loss`
+    uint64_t burst_lost = 0;                 // In the bad Gilbert-Elliott state
+    uint64_t queue_dropped = 0;              // Tail-dropped behind the bandwidth cap
+    uint64_t duplicated = 0;
+    uint64_t reordered = 0;
+    uint64_t unreachable = 0;                // No socket bound to the destination
+    uint64_t socket_overflows = 0;           // Receive queue of the destination socket was full
+  };
+
+public:
+  explicit SimulatedLink(const asio::any_io_executor& executor, const uint64_t seed = 1);
+  SimulatedLink(const SimulatedLink&) = delete;
+  SimulatedLink& operator=(const SimulatedLink&) = delete;
+
+  // For datagrams to destinations without impairments of their own
+  void SetImpairments(const Impairments& impairments);
+
+  // For datagrams to `destination` only, e.g. the data direction of a stream but not its resend requests
+  void SetImpairments(const asio::ip::udp::endpoint& destination, const Impairments& impairments);
+
+  Stats GetStats() const;
+
+  // Link clock in nanoseconds since construction
+  uint64_t Now() const;
+
+  // Strand the link delivers on; simulated sockets complete their operations on it
+  asio::any_io_executor GetExecutor() const;
+
+private:
+  friend class SimulatedSocket;
+
+  struct Datagram {
+    uint64_t due;       // Link clock
+    uint64_t sequence;  // Keeps datagrams due at the same time in send order
+    asio::ip::udp::endpoint source;
+    asio::ip::udp::endpoint destination;
+    std::vector<uint8_t> data;
+  };
+
+  struct LaterDue {
+    bool operator()(const Datagram& a, const Datagram& b) const {
+      return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+    }
+  };
+
+  // Impairments and state of the datagrams to one destination
+  struct Path {
+    Impairments impairments;
+    bool bad = false;         // Gilbert-Elliott state
+    uint64_t busy_until = 0;  // Link clock when the bandwidth cap lets the next datagram out
+  };
+
+  // @return The endpoint the socket is bound to, with a free port if `endpoint` has none
+  asio::ip::udp::endpoint __Bind(SimulatedSocket* socket, const asio::ip::udp::endpoint& endpoint);
+  void __Unbind(const asio::ip::udp::endpoint& endpoint);
+
+  void __Transmit(const asio::ip::udp::endpoint& source, const asio::ip::udp::endpoint& destination,
+                  const uint8_t* data, const size_t size);
+
+  // Must be called with `mutex_` held
+  Path& __GetPath(const asio::ip::udp::endpoint& destination);
+  SimulatedSocket* __FindSocket(const asio::ip::udp::endpoint& destination);
+  void __Enqueue(Datagram datagram);
+  double __Uniform();
+
+  // Run on the strand
+  void __ArmTimer();
+  void __Deliver();
+
+private:
+  asio::any_io_executor executor_;
+  asio::steady_timer timer_;
+  uint64_t timer_due_ = UINT64_MAX;  // On the strand; UINT64_MAX if the timer is not armed
+  const std::chrono::steady_clock::time_point start_time_;
+
+  mutable std::mutex mutex_;
+  std::mt19937_64 random_;
+  Path default_path_;
+  std::map<asio::ip::udp::endpoint, Path> paths_;
+  std::map<asio::ip::udp::endpoint, SimulatedSocket*> sockets_;
+  unsigned short next_port_ = 49152;
+  std::priority_queue<Datagram, std::vector<Datagram>, LaterDue> in_flight_;
+  uint64_t sequence_ = 0;
+  uint64_t earliest_due_ = UINT64_MAX;  // Earliest due time a timer has been requested for
+  Stats stats_;
+};
+
+// Datagram socket on a `SimulatedLink`, with the subset of the `asio::ip::udp::socket`
+// interface used by `BasicSender` and `BasicReceiver`, e.g.
+// `BasicSender<DynamicLayout, SimulatedSocket>`. One receive may be pending at a time.
+// Operations complete on the link's strand. The link must outlive the socket.
+class SimulatedSocket {
+public:
+  using executor_type = asio::any_io_executor;
+  using ReceiveHandler = std::function<void(const std::error_code& error, std::size_t bytes_transferred)>;
+  using SendHandler = std::function<void(const std::error_code& error, std::size_t bytes_transferred)>;
+
+public:
+  // @param local_endpoint Address and port to bind to; port 0 picks a free one
+  // @param receive_queue_size Datagrams queued while no receive is pending, like a socket buffer
+  SimulatedSocket(SimulatedLink& link,
+                  const asio::ip::udp::endpoint& local_endpoint,
+                  const size_t receive_queue_size = 4096);
+  SimulatedSocket(const SimulatedSocket&) = delete;
+  SimulatedSocket& operator=(const SimulatedSocket&) = delete;
+  ~SimulatedSocket();
+
+  executor_type get_executor() const;
+  asio::ip::udp::endpoint local_endpoint() const;
+
+  void async_receive_from(const asio::mutable_buffer& buffer,
+                          asio::ip::udp::endpoint& sender_endpoint,
+                          ReceiveHandler handler);
+
+  void async_send_to(const asio::const_buffer& buffer,
+                     const asio::ip::udp::endpoint& destination,
+                     SendHandler handler);
+
+  std::size_t send_to(const asio::const_buffer& buffer, const asio::ip::udp::endpoint& destination);
+
+  // Completes a pending receive with `asio::error::operation_aborted`
+  void cancel();
+
+  const size_t RECEIVE_QUEUE_SIZE;
+
+private:
+  friend class SimulatedLink;
+
+  // Called by the link with its `mutex_` held.
+  // @return false if the receive queue is full
+  bool __Arrive(SimulatedLink::Datagram& datagram);
+
+private:
+  SimulatedLink& link_;
+  asio::ip::udp::endpoint local_endpoint_;
+
+  // Guarded by the link's `mutex_`
+  std::deque<SimulatedLink::Datagram> received_;
+  ReceiveHandler pending_;
+  asio::mutable_buffer pending_buffer_;
+  asio::ip::udp::endpoint* pending_endpoint_ = nullptr;
+};
+
+}
+
+#endif
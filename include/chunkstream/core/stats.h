@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_STATS_H_
+#define CHUNKSTREAM_CORE_STATS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace chunkstream {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Counter on a cache line of its own, so that counters bumped by different threads
+// (e.g. a sending thread and the network thread) do not invalidate each other's lines.
+// Updates are relaxed; a snapshot is consistent per counter, not across counters.
+class alignas(CACHE_LINE_SIZE) StatCounter {
+public:
+  void Add(const uint64_t n = 1) {
+    value_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  uint64_t Get() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> value_ = 0;
+};
+
+// Snapshot of a receiver's counters since construction
+struct ReceiverStats {
+  uint64_t packets_received = 0;        // Counted once handled
+  uint64_t bytes_received = 0;          // Including chunk headers
+  uint64_t malformed_packets = 0;       // Datagrams with an invalid header or shorter than their chunk
+  uint64_t duplicate_chunks = 0;        // Chunks already added to their frame
+  uint64_t late_chunks = 0;             // Chunks of frames no longer assembling
+  uint64_t no_buffer_chunks = 0;        // Chunks of new frames dropped without a free frame or data block
+  uint64_t no_packet_buffer = 0;        // Receives not started because all packet buffers were in use
+  uint64_t kernel_drops = 0;            // Datagrams the kernel dropped with the socket buffer full;
+                                        // counted only with `SetKernelTimestamps(true)`
+  uint64_t resend_requests_sent = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t frames_completed = 0;
+  uint64_t frames_timed_out = 0;        // Dropped by FRAME_DROP_TIMEOUT or the frame deadline
+  uint64_t frames_abandoned = 0;        // Dropped by latest-only or ordered delivery
+
+  // Occupancy when the snapshot was taken
+  size_t frames_in_use = 0;
+  size_t frame_slots = 0;               // `buffer_size`
+  size_t data_blocks_in_use = 0;
+  size_t data_block_bytes = 0;          // Allocated by the frame store, in use or not
+};
+
+// Snapshot of a sender's counters since construction
+struct SenderStats {
+  uint64_t frames_sent = 0;
+  uint64_t packets_sent = 0;            // INIT and resent chunks handed to the kernel
+  uint64_t bytes_sent = 0;              // Including chunk headers
+  uint64_t send_errors = 0;
+  uint64_t resend_requests_received = 0;
+  uint64_t resends_served = 0;
+  uint64_t resends_missed = 0;          // Requested frame no longer in the circular buffer
+  uint64_t would_block = 0;             // `TrySend()` calls refused
+  uint64_t blocked_sends = 0;           // `Send()` and `AsyncSend()` calls which waited for a slot
+
+  // Occupancy when the snapshot was taken
+  size_t busy_slots = 0;
+  size_t slot_count = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_CORE_TRACE_H_
+#define CHUNKSTREAM_CORE_TRACE_H_
+
+// Statically defined tracing probes (USDT) of provider `chunkstream`, which bpftrace or perf
+// can attach to in a running process, e.g.
+//   bpftrace -e 'usdt:./app:chunkstream:frame_drop { printf("frame %u dropped\n", arg0); }'
+// An unattached probe is a single nop. Without CHUNKSTREAM_USDT or <sys/sdt.h>
+// the probes and their arguments compile to nothing.
+//
+// Receiver
+//   receive_packet(id, chunk_index, total_chunks, chunk_size, total_size)  Valid header arrived
+//   add_chunk(id, chunk_index, chunk_size, received_chunks, total_chunks)  Chunk copied into its frame
+//   resend_request(id, chunk_index, total_chunks)                          Missing chunk requested
+//   frame_ready(id, total_size, resend_rounds, assembly_ns)                Frame completed
+//   frame_drop(id, total_size, received_chunks, reason)                    0: timed out, 1: abandoned
+// Sender
+//   send_chunk(id, chunk_index, total_chunks, chunk_size, total_size)      INIT chunk handed to the socket
+//   resend_chunk(id, chunk_index, chunk_size)                              Requested chunk sent again
+
+#if defined(CHUNKSTREAM_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CHUNKSTREAM_HAS_USDT 1
+#endif
+#endif
+
+#ifdef CHUNKSTREAM_HAS_USDT
+#define CHUNKSTREAM_PROBE3(name, a1, a2, a3) \
+  DTRACE_PROBE3(chunkstream, name, a1, a2, a3)
+#define CHUNKSTREAM_PROBE4(name, a1, a2, a3, a4) \
+  DTRACE_PROBE4(chunkstream, name, a1, a2, a3, a4)
+#define CHUNKSTREAM_PROBE5(name, a1, a2, a3, a4, a5) \
+  DTRACE_PROBE5(chunkstream, name, a1, a2, a3, a4, a5)
+#else
+#define CHUNKSTREAM_PROBE3(name, a1, a2, a3) ((void)0)
+#define CHUNKSTREAM_PROBE4(name, a1, a2, a3, a4) ((void)0)
+#define CHUNKSTREAM_PROBE5(name, a1, a2, a3, a4, a5) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_METRICS_H_
+#define CHUNKSTREAM_METRICS_H_
+
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chunkstream/core/histogram.h"
+#include "chunkstream/core/stats.h"
+
+namespace chunkstream {
+
+// Exposes the stats and histograms of senders and receivers in OpenMetrics text format,
+// either on http://127.0.0.1:<port>/metrics or in a file rewritten on an interval.
+// Built as the separate `chunkstream_metrics` library.
+// Every series is labelled with the stream's `port` and `peer`.
+class MetricsExporter {
+public:
+  MetricsExporter() = default;
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+  ~MetricsExporter();
+
+  // Labelled with the receiver's local port. Remove it before it is destroyed.
+  // @param peer Value of the `peer` label, e.g. the address of the expected sender
+  template<typename Receiver>
+  void AddReceiver(const Receiver& receiver, const std::string& peer = "");
+
+  // Labelled with the sender's remote port and address. Remove it before it is destroyed.
+  template<typename Sender>
+  void AddSender(const Sender& sender);
+
+  // @param source Sender or receiver given to `AddSender()`/`AddReceiver()`
+  void Remove(const void* source);
+
+  // @return Metrics of all streams, ending with `# EOF`
+  std::string Render() const;
+
+  // Serves `Render()` on 127.0.0.1:`port` from a background thread.
+  // @return false if the port could not be bound
+  bool ServeHttp(const unsigned short port);
+
+  // Writes `Render()` to `path` every `interval` from a background thread. The file is written
+  // next to `path` and renamed over it, so a reader never sees a partial file.
+  void DumpToFile(const std::string& path, const std::chrono::milliseconds interval);
+
+  // Stops serving and dumping; called by the destructor.
+  void Stop();
+
+private:
+  struct ReceiverSource {
+    const void* source;
+    std::string labels;
+    std::function<ReceiverStats()> stats;
+    // Assembly time, resend recovery time, resend rounds, hold time and socket queue time
+    std::array<const Histogram*, 5> histograms;
+  };
+
+  struct SenderSource {
+    const void* source;
+    std::string labels;
+    std::function<SenderStats()> stats;
+  };
+
+  class HttpSession;
+
+  void __AddReceiver(ReceiverSource source);
+  void __AddSender(SenderSource source);
+  void __Accept();
+  void __Dump(const std::string& path, const std::chrono::milliseconds interval);
+
+  // @return `port="<port>",peer="<peer>"`
+  static std::string __Labels(const unsigned short port, const std::string& peer);
+
+private:
+  mutable std::mutex sources_mutex_;
+  std::vector<ReceiverSource> receivers_;
+  std::vector<SenderSource> senders_;
+
+  asio::io_context io_context_;
+  std::unique_ptr<asio::ip::tcp::acceptor> acceptor_;
+  std::thread http_thread_;
+
+  std::thread dump_thread_;
+  std::mutex dump_mutex_;
+  std::condition_variable dump_stopped_;
+  bool stopped_ = false; // Guarded by `dump_mutex_`
+};
+
+template<typename Receiver>
+void MetricsExporter::AddReceiver(const Receiver& receiver, const std::string& peer) {
+  ReceiverSource source;
+  source.source = &receiver;
+  source.labels = __Labels(receiver.GetLocalEndpoint().port(), peer);
+  source.stats = [&receiver]() { return receiver.GetStats(); };
+  source.histograms = {
+    &receiver.GetAssemblyTime(), &receiver.GetResendRecoveryTime(),
+    &receiver.GetResendRounds(), &receiver.GetHoldTime(),
+    &receiver.GetSocketQueueTime()
+  };
+  __AddReceiver(std::move(source));
+}
+
+template<typename Sender>
+void MetricsExporter::AddSender(const Sender& sender) {
+  SenderSource source;
+  source.source = &sender;
+  source.labels = __Labels(sender.GetRemoteEndpoint().port(),
+                           sender.GetRemoteEndpoint().address().to_string());
+  source.stats = [&sender]() { return sender.GetStats(); };
+  __AddSender(std::move(source));
+}
+
+}
+
+#endif
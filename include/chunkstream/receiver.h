@@ -4,70 +4,1180 @@
 #ifndef CHUNKSTREAM_RECEIVER_H_
 #define CHUNKSTREAM_RECEIVER_H_
 
+#include <algorithm>
 #include <asio.hpp>
+#include <chrono>
 #include <functional>
-#include <queue>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+#endif
+#include "chunkstream/receiver/dispatcher.h"
+#include "chunkstream/receiver/frame_queue.h"
+#include "chunkstream/receiver/frame_view.h"
 #include "chunkstream/receiver/receiving_frame.h"
+#include "chunkstream/core/capture.h"
 #include "chunkstream/core/chunk_header.h"
+#include "chunkstream/core/flight_recorder.h"
+#include "chunkstream/core/histogram.h"
 #include "chunkstream/core/ordered_hash_container.h"
+#include "chunkstream/core/packet_layout.h"
+#include "chunkstream/core/pending_count.h"
+#include "chunkstream/core/simulated_link.h"
+#include "chunkstream/core/stats.h"
+#include "chunkstream/core/trace.h"
 #include "chunkstream/receiver/memory_pool.h"
+#include "chunkstream/receiver/size_class_pool.h"
 
 namespace chunkstream {
 
-class Receiver {
+// @tparam Handler Callable invoked for every assembled frame, either as `grab(FrameView frame)`
+//                 to read the frame in place, or as `grab(const std::vector<uint8_t>& data, Releaser release)`
+//                 to get a copy. Using a concrete callable type (e.g. a lambda) instead of
+//                 `std::function` lets the compiler inline the whole delivery path.
+// @tparam Layout `DynamicLayout` for a MTU given at runtime, or `StaticLayout<MTU>`
+//                to fix chunk math at compile time.
+// @tparam Socket `asio::ip::udp::socket`, or a type with the same `async_receive_from()`, `send_to()`,
+//                `cancel()` and `local_endpoint()`, e.g. `SimulatedSocket`.
+template<typename Handler, typename Layout = DynamicLayout, typename Socket = asio::ip::udp::socket>
+class BasicReceiver {
 public:
-  Receiver(const int port, 
-           std::function<void(const std::vector<uint8_t>& data, std::function<void()> Release)> grab,
-           const int mtu = 1500, 
-           const size_t buffer_size = 10, 
-           const size_t max_data_size = 0) ;
-  ~Receiver();
-
-  // It will block thread
+  using Frame = BasicReceivingFrame<BasicReceiver>;
+  using LayoutType = Layout;
+
+  // @param data Frame buffer; only the first `ready_size` bytes are valid, and only during the call
+  using ProgressCallback = std::function<void(const uint32_t id,
+                                              const uint8_t* data,
+                                              const size_t ready_size,
+                                              const size_t total_size)>;
+
+  // Releases the buffer of a grabbed frame. Cheap to copy; converts to `std::function<void()>`.
+  class Releaser {
+  public:
+    Releaser(BasicReceiver* receiver, const uint32_t id)
+      : receiver_(receiver), id_(id) {}
+
+    void operator()() const {
+      receiver_->__ReleaseFrame(id_);
+    }
+
+  private:
+    BasicReceiver* receiver_;
+    uint32_t id_;
+  };
+
+public:
+  // Runs on an io_context owned by the receiver; `Start()` blocks the calling thread running it.
+  // @param max_data_size Largest frame accepted, or 0 for no limit.
+  //                      Frame buffers are sized by each frame's `total_size`.
+  BasicReceiver(const int port,
+                Handler grab,
+                const int mtu = Layout::DEFAULT_MTU,
+                const size_t buffer_size = 10,
+                const size_t max_data_size = 0) ;
+
+  // Runs on `executor` (e.g. `io_context.get_executor()` or a thread pool's executor), so that
+  // many receivers can share a fixed set of I/O threads. Handlers are serialized on a strand.
+  // The executor must keep running until the receiver is stopped.
+  BasicReceiver(const asio::any_io_executor& executor,
+                const int port,
+                Handler grab,
+                const int mtu = Layout::DEFAULT_MTU,
+                const size_t buffer_size = 10,
+                const size_t max_data_size = 0);
+
+  // Receives on an open, bound `socket` (e.g. one with socket options or multicast groups
+  // set up by the caller) and runs on its executor, which must not run handlers concurrently
+  // and must keep running until the receiver is stopped.
+  BasicReceiver(std::unique_ptr<Socket> socket,
+                Handler grab,
+                const int mtu = Layout::DEFAULT_MTU,
+                const size_t buffer_size = 10,
+                const size_t max_data_size = 0);
+  ~BasicReceiver();
+
+  // Blocks the thread running the receiver's own io_context,
+  // or starts receiving on the external executor and returns at once.
   void Start();
+
+  // Also closes the `FrameQueue` of a `PullReceiver`, so a network thread blocked on it returns.
+  // On an external executor, it waits until all handlers of the receiver have run,
+  // so it must not be called from one of the executor's threads.
   void Stop();
   void Flush();
+
+  // Reports the contiguous prefix of assembling frames as it grows, so large frames can be
+  // consumed before their last chunk arrives. Called on the network thread; set it before `Start()`.
+  // @param step Reports only when the prefix crosses a multiple of `step` bytes, or 0 for every advance.
+  //             The completed frame is always reported before it is grabbed.
+  void SetProgressCallback(ProgressCallback progress, const size_t step = 0);
+
+  // Drops frames which are not complete `deadline` after their first chunk arrived,
+  // instead of requesting resends until FRAME_DROP_TIMEOUT. 0 disables it. Set it before `Start()`.
+  void SetFrameDeadline(const std::chrono::milliseconds deadline);
+
+  // When a frame completes, older frames still assembling are dropped at once and their
+  // buffers released, and later chunks of older frames are ignored. Set it before `Start()`.
+  void SetLatestOnly(const bool latest_only);
+
+  // Delivers frames in id order. A completed frame is held back until every earlier frame
+  // is delivered or dropped; once more than `window` frames are held, or no chunk of a missing
+  // frame arrived within GAP_TIMEOUT (or the frame deadline) of the frame held behind it, the
+  // frames still missing in front of them are dropped. 0 delivers in completion order. Set it before `Start()`.
+  // Held frames keep their slot of `buffer_size`, so `window` should be smaller than it.
+  void SetOrderedDelivery(const size_t window);
+
+  // Records the lifecycle of every frame in `recorder`, tagged with `stream`, or nullptr to stop.
+  // The recorder must outlive the receiver or be unset. Set it before `Start()`.
+  void SetFlightRecorder(FlightRecorder* recorder, const uint8_t stream = 0);
+
+  // Writes every received datagram, malformed ones included, to `capture` with its arrival time
+  // (the kernel timestamp if enabled), or nullptr to stop. Replay it with `chunkstream_replay`.
+  // The capture must outlive the receiver or be unset. Set it before `Start()`.
+  void SetCapture(CaptureWriter* capture);
+
+  // Handles `data` as a datagram from `sender_endpoint` which arrived at `arrival`, e.g. to replay
+  // a capture; resend requests go out through the socket as usual. `data` is copied and handled
+  // on the receiver's executor, so it may be called from any thread while the receiver runs.
+  // @return false if no packet buffer is free; retry once the receiver has caught up
+  bool Inject(const asio::ip::udp::endpoint& sender_endpoint, const uint8_t* data, const size_t size,
+              const std::chrono::system_clock::time_point arrival = std::chrono::system_clock::time_point());
+
+  // Reads the kernel arrival timestamp (SO_TIMESTAMPNS) and the socket buffer drop count
+  // (SO_RXQ_OVFL) of every datagram, through `recvmsg()` instead of asio's receive.
+  // Drops are reported as `ReceiverStats::kernel_drops`, and both are attached to frame views.
+  // Linux `asio::ip::udp::socket` only. Set it before `Start()`.
+  // @return false if the options cannot be enabled
+  bool SetKernelTimestamps(const bool enable);
+
+  // Counters are kept across `Stop()`/`Start()`
   size_t GetFrameCount() const;
   size_t GetDropCount() const;
 
+  // Cheap enough to poll from a monitoring thread while receiving
+  ReceiverStats GetStats() const;
+
+  asio::ip::udp::endpoint GetLocalEndpoint() const;
+
+  // Histograms recorded for every completed frame; times are in nanoseconds.
+  // From the first to the last chunk of the frame
+  const Histogram& GetAssemblyTime() const;
+  // From the first resend request to completion, for frames which needed resends
+  const Histogram& GetResendRecoveryTime() const;
+  // Number of resend rounds (not a time), including frames which needed none
+  const Histogram& GetResendRounds() const;
+  // From handing the frame to the handler until it is released
+  const Histogram& GetHoldTime() const;
+  // From the kernel timestamp of a datagram until the receiver reads it; with kernel timestamps only
+  const Histogram& GetSocketQueueTime() const;
+
 public:
+  const Layout LAYOUT;
   const size_t BUFFER_SIZE;
   const size_t MTU;
   const size_t PAYLOAD;
 
-private: 
+  // Smallest frame buffer allocated by the frame store
+  static constexpr size_t MIN_FRAME_BLOCK_SIZE = 64 * 1024;
+
+  // Number of packet buffers for in-flight receives
+  static constexpr size_t RAW_BUFFER_COUNT = 4;
+
+  // How long ordered delivery waits for frames of which no chunk arrived yet
+  static constexpr std::chrono::milliseconds GAP_TIMEOUT = std::chrono::milliseconds(100);
+
+  // Number of recently completed or dropped frames whose late chunks are dropped, and for how long;
+  // a late original chunk would otherwise start a released frame again, and resends complete it twice
+  static constexpr size_t FINISHED_ID_COUNT = 256;
+  static constexpr std::chrono::milliseconds FINISHED_ID_TIMEOUT = std::chrono::milliseconds(1000);
+
+private:
+  friend Frame;
+
+  // @param socket Opened on `port` if nullptr
+  BasicReceiver(std::shared_ptr<asio::io_context> io_context,
+                const asio::any_io_executor& executor,
+                std::unique_ptr<Socket>&& socket,
+                const int port,
+                Handler grab,
+                const int mtu,
+                const size_t buffer_size,
+                const size_t max_data_size);
+
   void __Receive();
-  void __HandlePacket(const asio::ip::udp::endpoint& sender_endpoint, uint8_t* recv_buf);
+#ifdef __linux__
+  // Waits until the socket is readable, then reads queued datagrams with their control messages
+  void __ReceiveMessages();
+  // @return false if no datagram was queued
+  bool __ReceiveMessage(uint8_t* recv_buf);
+#endif
+  // Counts and captures a received datagram and handles it if it is not malformed
+  void __HandleDatagram(const asio::ip::udp::endpoint& sender_endpoint, uint8_t* recv_buf, const size_t size);
+  // @param size Of the whole datagram, at least CHUNKHEADER_SIZE
+  void __HandlePacket(const asio::ip::udp::endpoint& sender_endpoint, uint8_t* recv_buf, const size_t size);
   void __RequestResend(const ChunkHeader header, const asio::ip::udp::endpoint endpoint);
-  void __FrameGrabbed(const uint32_t id, uint8_t* data, const size_t size);
+  void __FrameGrabbed(Frame* frame);
+  void __FrameProgress(Frame* frame, const size_t previous_ready_size);
+  void __FrameDropped(const uint32_t id, uint8_t* data);
+
+  // Drops the frames older than `id` which are still assembling
+  void __AbandonOlderFrames(const uint32_t id);
+
+  // Remembers a completed or dropped frame in `finished_ids_`
+  void __FrameFinished(const uint32_t id);
+  // @return Whether the frame was completed or dropped within FINISHED_ID_TIMEOUT
+  bool __IsFinished(const uint32_t id) const;
 
-private: 
+  // Hands a completed frame to `grabbed_`
+  void __DeliverFrame(Frame* frame);
+
+  // Delivers held frames from `next_id_` on, as far as no earlier frame is still assembling
+  // or can still arrive; arms `gap_timer_` for the latter
+  void __DeliverHeldFrames();
+  void __WaitGap(const std::chrono::steady_clock::time_point expiry);
+
+  // Takes a frame out of `assembling_queue_` and returns it and its data block to the pools.
+  void __ReleaseFrame(const uint32_t id);
+  static void __ReleaseFrameView(void* receiver, const uint32_t id);
+  Frame* __AcquireFrame();
+  void __RecycleFrame(Frame* frame);
+
+  // @return The queue frames are delivered to, or nullptr if the handler is not a `FrameQueue`
+  FrameQueue* __GetFrameQueue();
+
+  static uint64_t __Nanoseconds(const std::chrono::steady_clock::duration duration);
+
+private:
   std::atomic_bool running_ = false;
-  std::function< void(const std::vector<uint8_t>&, std::function<void()>) > grabbed_;
-  std::unique_ptr<asio::ip::udp::socket> socket_;
+  Handler grabbed_;
+  ProgressCallback progress_;
+  size_t progress_step_ = 0;
+  std::shared_ptr<asio::io_context> io_context_; // nullptr if running on an external executor
+  asio::any_io_executor executor_;
+  std::unique_ptr<Socket> socket_;
   asio::ip::udp::endpoint remote_endpoint_;
-  std::shared_ptr<asio::io_context> io_context_ = std::make_shared<asio::io_context>();
+  PendingCount pending_receives_;
 
-  // [ <-- BLOCK_SIZE * BUFFER_SIZE --> ]
-  // block: one data (assembled packets)
-  MemoryPool data_pool_;
+  bool kernel_timestamps_ = false;
+  std::chrono::system_clock::time_point kernel_time_; // Of the datagram being handled
+  uint32_t socket_drops_ = 0; // Last SO_RXQ_OVFL value; wraps around
 
-  // [ <-- PACKET_SIZE * EXPECTED_CHUNK_COUNT * BUFFER_SIZE --> ]
+  // Up to BUFFER_SIZE blocks of size classes, four per power of two
+  // block: one data (assembled packets), sized by its `total_size`
+  SizeClassPool data_pool_;
+
+  // [ <-- PACKET_SIZE * RAW_BUFFER_COUNT --> ]
   // block: one packet
   MemoryPool raw_pool_;
-  
+
   // [ <-- CHUNKHEADER_SIZE * BUFFER_SIZE --> ]
   // block: one chunk_header
   MemoryPool resend_pool_;
 
-  std::queue< std::pair<uint32_t, uint8_t*> > dropped_queue_;
+  // Ids of dropped frames; at most BUFFER_SIZE
+  std::vector<uint32_t> dropped_queue_;
+
+  bool latest_only_ = false;
+  bool has_latest_id_ = false;
+  uint32_t latest_id_ = 0; // Last completed frame in latest-only mode
+  std::vector< std::pair<uint32_t, Frame*> > abandoned_frames_; // Scratch of `__AbandonOlderFrames()`
+
+  struct FinishedId {
+    uint32_t id = 0;
+    std::chrono::steady_clock::time_point time; // The epoch if unused
+  };
+  std::vector<FinishedId> finished_ids_; // Ring of the last FINISHED_ID_COUNT finished frames
+  size_t finished_id_next_ = 0;
+
+  FlightRecorder* recorder_ = nullptr;
+  uint8_t stream_ = 0;
 
-  OrderedHashContainer<uint32_t, std::shared_ptr<ReceivingFrame> > assembling_queue_;
+  CaptureWriter* capture_ = nullptr;
+  asio::ip::udp::endpoint capture_endpoint_; // Destination of captured datagrams
 
-  std::atomic<size_t> assembled_count_ = 0;
-  std::atomic<size_t> dropped_count_ = 0;
+  size_t ordered_window_ = 0;
+  bool has_next_id_ = false;
+  uint32_t next_id_ = 0; // Next frame to deliver in ordered mode
+  std::vector<Frame*> held_frames_; // Completed frames waiting for earlier ones, sorted by id
+  std::chrono::milliseconds gap_timeout_ = GAP_TIMEOUT; // The frame deadline if it is shorter
+  asio::steady_timer gap_timer_;    // Expires when missing frames in front of `held_frames_` are given up
+  std::chrono::steady_clock::time_point gap_expiry_; // Of the armed `gap_timer_`, or zero
+
+  OrderedHashContainer<uint32_t, Frame*> assembling_queue_;
+
+  // BUFFER_SIZE frames constructed at startup and reused through `Frame::Reset()`
+  std::vector< std::unique_ptr<Frame> > frames_;
+  std::vector<Frame*> free_frames_;
+  mutable std::mutex frames_mutex_;
+
+  StatCounter packets_received_;
+  StatCounter bytes_received_;
+  StatCounter malformed_packets_;
+  StatCounter duplicate_chunks_;
+  StatCounter late_chunks_;
+  StatCounter no_buffer_chunks_;
+  StatCounter no_packet_buffer_;
+  StatCounter resend_requests_sent_;
+  StatCounter bytes_sent_;
+  StatCounter assembled_count_;
+  StatCounter timed_out_count_;
+  StatCounter abandoned_count_;
+  StatCounter kernel_drops_;
+
+  Histogram assembly_time_;
+  Histogram resend_recovery_time_;
+  Histogram resend_rounds_;
+  Histogram hold_time_; // Recorded on the thread releasing the frame
+  Histogram socket_queue_time_;
 };
 
+template<typename Handler, typename Layout, typename Socket>
+BasicReceiver<Handler, Layout, Socket>::BasicReceiver(const int port,
+                                                      Handler grab,
+                                                      const int mtu,
+                                                      const size_t buffer_size,
+                                                      const size_t max_data_size)
+: BasicReceiver(std::make_shared<asio::io_context>(), asio::any_io_executor(), nullptr,
+                port, std::move(grab), mtu, buffer_size, max_data_size) {}
+
+template<typename Handler, typename Layout, typename Socket>
+BasicReceiver<Handler, Layout, Socket>::BasicReceiver(const asio::any_io_executor& executor,
+                                                      const int port,
+                                                      Handler grab,
+                                                      const int mtu,
+                                                      const size_t buffer_size,
+                                                      const size_t max_data_size)
+: BasicReceiver(nullptr, executor, nullptr, port, std::move(grab), mtu, buffer_size, max_data_size) {}
+
+template<typename Handler, typename Layout, typename Socket>
+BasicReceiver<Handler, Layout, Socket>::BasicReceiver(std::unique_ptr<Socket> socket,
+                                                      Handler grab,
+                                                      const int mtu,
+                                                      const size_t buffer_size,
+                                                      const size_t max_data_size)
+: BasicReceiver(nullptr, socket->get_executor(), std::move(socket), 0,
+                std::move(grab), mtu, buffer_size, max_data_size) {}
+
+template<typename Handler, typename Layout, typename Socket>
+BasicReceiver<Handler, Layout, Socket>::BasicReceiver(std::shared_ptr<asio::io_context> io_context,
+                                                      const asio::any_io_executor& executor,
+                                                      std::unique_ptr<Socket>&& socket,
+                                                      const int port,
+                                                      Handler grab,
+                                                      const int mtu,
+                                                      const size_t buffer_size,
+                                                      const size_t max_data_size)
+: LAYOUT(mtu),
+  BUFFER_SIZE(buffer_size),
+  MTU(LAYOUT.MTU),
+  PAYLOAD(LAYOUT.PAYLOAD),
+  grabbed_(std::move(grab)),
+  io_context_(std::move(io_context)),
+  executor_(io_context_ ? asio::any_io_executor(io_context_->get_executor())
+                        : asio::any_io_executor(asio::make_strand(executor))),
+  data_pool_(MIN_FRAME_BLOCK_SIZE, max_data_size, buffer_size),
+  raw_pool_(LAYOUT.PACKET_SIZE, RAW_BUFFER_COUNT),
+  resend_pool_(CHUNKHEADER_SIZE, buffer_size),
+  gap_timer_(executor_)
+{
+  try {
+    if (socket) {
+      socket_ = std::move(socket);
+    } else {
+      if constexpr (std::is_same_v<Socket, asio::ip::udp::socket>) {
+        socket_ = std::make_unique<asio::ip::udp::socket>(
+          executor_,
+          asio::ip::udp::endpoint(asio::ip::udp::v4(), port)
+        );
+      } else {
+        throw std::invalid_argument("This socket type must be opened by the caller");
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error initializing Receiver: " << e.what() << std::endl;
+    throw;
+  }
+
+  // Pre-allocate frames so that receiving does not allocate
+  frames_.reserve(BUFFER_SIZE);
+  free_frames_.reserve(BUFFER_SIZE);
+  for (size_t i = 0; i < BUFFER_SIZE; i++) {
+    frames_.push_back(std::make_unique<Frame>(executor_, LAYOUT, this));
+    free_frames_.push_back(frames_.back().get());
+  }
+  assembling_queue_.reserve(BUFFER_SIZE);
+  dropped_queue_.reserve(BUFFER_SIZE);
+  abandoned_frames_.reserve(BUFFER_SIZE);
+  held_frames_.reserve(BUFFER_SIZE);
+  finished_ids_.resize(FINISHED_ID_COUNT);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+BasicReceiver<Handler, Layout, Socket>::~BasicReceiver() {
+  Stop();
+  // Queued views would release frames into a destroyed receiver
+  if constexpr (std::is_same_v<Handler, std::reference_wrapper<FrameQueue>>
+                || std::is_same_v<Handler, std::reference_wrapper<Dispatcher>>) {
+    grabbed_.get().Clear(this);
+  }
+  if (io_context_) {
+    // The stopped io_context still holds the handlers of the socket and frame timers; run them
+    // out, so that destroying the socket does not complete them into destroyed frames
+    try {
+      socket_->cancel();
+    } catch (const std::exception& e) {
+      std::cerr << "Cancel error: " << e.what() << std::endl;
+    }
+    for (const std::unique_ptr<Frame>& frame : frames_) {
+      frame->Cancel();
+    }
+    gap_timer_.cancel();
+    io_context_->restart();
+    io_context_->poll();
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::Start() {
+  running_ = true;
+  if (FrameQueue* queue = __GetFrameQueue()) {
+    queue->Open();
+  }
+  __Receive();
+  if (io_context_) {
+    io_context_->run();
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::Stop() {
+  running_ = false;
+  if (FrameQueue* queue = __GetFrameQueue()) {
+    queue->Close();
+  }
+  if (io_context_) {
+    io_context_->stop();
+  } else {
+    // Handlers still queued on the executor refer to this receiver; cancel and wait for them
+    pending_receives_.Add();
+    asio::post(executor_, [this]() {
+      try {
+        socket_->cancel();
+      } catch (const std::exception& e) {
+        std::cerr << "Cancel error: " << e.what() << std::endl;
+      }
+      for (const std::unique_ptr<Frame>& frame : frames_) {
+        frame->Cancel();
+      }
+      gap_timer_.cancel();
+      gap_expiry_ = std::chrono::steady_clock::time_point();
+      pending_receives_.Done();
+    });
+    // A cancelled timer of a frame may still start a handler of the receiver
+    do {
+      pending_receives_.Wait();
+      for (const std::unique_ptr<Frame>& frame : frames_) {
+        frame->WaitPendingWaits();
+      }
+    } while (pending_receives_.Get() > 0);
+  }
+}
+
+// TO DO: Test this method
+// It also delete frames whose status is ASSEMBLING.
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::Flush() {
+  while (auto element = assembling_queue_.extract_front()) {
+    Frame* frame = element->second;
+    data_pool_.Release(frame->GetData());
+    __RecycleFrame(frame);
+  }
+  dropped_queue_.clear();
+  held_frames_.clear();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetProgressCallback(ProgressCallback progress, const size_t step) {
+  progress_ = std::move(progress);
+  progress_step_ = step;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetFrameDeadline(const std::chrono::milliseconds deadline) {
+  for (const std::unique_ptr<Frame>& frame : frames_) {
+    frame->SetDeadline(deadline);
+  }
+  gap_timeout_ = deadline.count() > 0 ? std::min(deadline, GAP_TIMEOUT) : GAP_TIMEOUT;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetLatestOnly(const bool latest_only) {
+  latest_only_ = latest_only;
+  has_latest_id_ = false;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetOrderedDelivery(const size_t window) {
+  ordered_window_ = window;
+  has_next_id_ = false;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetFlightRecorder(FlightRecorder* recorder, const uint8_t stream) {
+  recorder_ = recorder;
+  stream_ = stream;
+  for (const std::unique_ptr<Frame>& frame : frames_) {
+    frame->SetFlightRecorder(recorder, stream);
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::SetCapture(CaptureWriter* capture) {
+  capture_ = capture;
+  if (capture_) {
+    capture_endpoint_ = socket_->local_endpoint();
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+bool BasicReceiver<Handler, Layout, Socket>::Inject(const asio::ip::udp::endpoint& sender_endpoint,
+                                                    const uint8_t* data,
+                                                    const size_t size,
+                                                    const std::chrono::system_clock::time_point arrival) {
+  uint8_t* recv_buf = raw_pool_.Acquire();
+  if (!recv_buf) {
+    return false;
+  }
+  // Cut to the packet buffer, as a socket receive would
+  const size_t copied = std::min(size, raw_pool_.BLOCK_SIZE);
+  std::memcpy(recv_buf, data, copied);
+
+  pending_receives_.Add();
+  asio::post(executor_, [this, sender_endpoint, recv_buf, copied, arrival]() {
+    kernel_time_ = arrival;
+    __HandleDatagram(sender_endpoint, recv_buf, copied);
+    kernel_time_ = std::chrono::system_clock::time_point();
+    raw_pool_.Release(recv_buf);
+    pending_receives_.Done();
+  });
+  return true;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+bool BasicReceiver<Handler, Layout, Socket>::SetKernelTimestamps(const bool enable) {
+#ifdef __linux__
+  if constexpr (std::is_same_v<Socket, asio::ip::udp::socket>) {
+    const int value = enable ? 1 : 0;
+    const int socket = socket_->native_handle();
+    if (setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &value, sizeof(value)) != 0
+        || setsockopt(socket, SOL_SOCKET, SO_RXQ_OVFL, &value, sizeof(value)) != 0) {
+      std::cerr << "Kernel timestamps error: " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    kernel_timestamps_ = enable;
+    return true;
+  }
+#endif
+  if (enable) {
+    std::cerr << "Kernel timestamps error: Not supported by this platform or socket type" << std::endl;
+  }
+  return !enable;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+size_t BasicReceiver<Handler, Layout, Socket>::GetFrameCount() const {
+  return assembled_count_.Get();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+size_t BasicReceiver<Handler, Layout, Socket>::GetDropCount() const {
+  return timed_out_count_.Get() + abandoned_count_.Get();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+ReceiverStats BasicReceiver<Handler, Layout, Socket>::GetStats() const {
+  ReceiverStats stats;
+  stats.packets_received = packets_received_.Get();
+  stats.bytes_received = bytes_received_.Get();
+  stats.malformed_packets = malformed_packets_.Get();
+  stats.duplicate_chunks = duplicate_chunks_.Get();
+  stats.late_chunks = late_chunks_.Get();
+  stats.no_buffer_chunks = no_buffer_chunks_.Get();
+  stats.no_packet_buffer = no_packet_buffer_.Get();
+  stats.kernel_drops = kernel_drops_.Get();
+  stats.resend_requests_sent = resend_requests_sent_.Get();
+  stats.bytes_sent = bytes_sent_.Get();
+  stats.frames_completed = assembled_count_.Get();
+  stats.frames_timed_out = timed_out_count_.Get();
+  stats.frames_abandoned = abandoned_count_.Get();
+  {
+    std::lock_guard<std::mutex> lock(frames_mutex_);
+    stats.frames_in_use = frames_.size() - free_frames_.size();
+  }
+  stats.frame_slots = BUFFER_SIZE;
+  stats.data_blocks_in_use = data_pool_.GetUsedCount();
+  stats.data_block_bytes = data_pool_.GetAllocatedBytes();
+  return stats;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+asio::ip::udp::endpoint BasicReceiver<Handler, Layout, Socket>::GetLocalEndpoint() const {
+  return socket_->local_endpoint();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+const Histogram& BasicReceiver<Handler, Layout, Socket>::GetAssemblyTime() const {
+  return assembly_time_;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+const Histogram& BasicReceiver<Handler, Layout, Socket>::GetResendRecoveryTime() const {
+  return resend_recovery_time_;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+const Histogram& BasicReceiver<Handler, Layout, Socket>::GetResendRounds() const {
+  return resend_rounds_;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+const Histogram& BasicReceiver<Handler, Layout, Socket>::GetHoldTime() const {
+  return hold_time_;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+const Histogram& BasicReceiver<Handler, Layout, Socket>::GetSocketQueueTime() const {
+  return socket_queue_time_;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__Receive() {
+#ifdef __linux__
+  if constexpr (std::is_same_v<Socket, asio::ip::udp::socket>) {
+    if (kernel_timestamps_) {
+      __ReceiveMessages();
+      return;
+    }
+  }
+#endif
+  uint8_t* recv_buf = raw_pool_.Acquire();
+  if (!recv_buf) {
+    no_packet_buffer_.Add();
+    std::cerr << "Receive error: No packet buffer is available" << std::endl;
+    return;
+  }
+  pending_receives_.Add();
+  socket_->async_receive_from(
+    asio::buffer(recv_buf, raw_pool_.BLOCK_SIZE),
+    remote_endpoint_,
+    [this, recv_buf](
+      const std::error_code& error, std::size_t bytes_transferred
+    ) {
+      if (error && running_) {
+        std::cerr << "Receive error(" << error << "): " << error.message() << std::endl;
+      }
+      if (!error) {
+        __HandleDatagram(remote_endpoint_, recv_buf, bytes_transferred);
+      }
+      raw_pool_.Release(recv_buf);
+      if (running_) __Receive();
+      pending_receives_.Done();
+    }
+  );
+}
+
+#ifdef __linux__
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__ReceiveMessages() {
+  // Only the UDP socket has a descriptor and kernel timestamps
+  if constexpr (!std::is_same_v<Socket, asio::ip::udp::socket>) {
+    return;
+  } else {
+    pending_receives_.Add();
+    socket_->async_wait(asio::ip::udp::socket::wait_read, [this](const std::error_code& error) {
+      if (error && running_) {
+        std::cerr << "Receive error(" << error << "): " << error.message() << std::endl;
+      }
+      if (!error) {
+        uint8_t* recv_buf = raw_pool_.Acquire();
+        if (!recv_buf) {
+          no_packet_buffer_.Add();
+          std::cerr << "Receive error: No packet buffer is available" << std::endl;
+        } else {
+          // Drains what is queued, bounded so that timers are not starved
+          for (size_t i = 0; i < BUFFER_SIZE + RAW_BUFFER_COUNT && running_ && __ReceiveMessage(recv_buf); i++) {}
+          raw_pool_.Release(recv_buf);
+        }
+      }
+      if (running_) __Receive();
+      pending_receives_.Done();
+    });
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+bool BasicReceiver<Handler, Layout, Socket>::__ReceiveMessage(uint8_t* recv_buf) {
+  // Only the UDP socket has a descriptor and kernel timestamps
+  if constexpr (!std::is_same_v<Socket, asio::ip::udp::socket>) {
+    return false;
+  } else {
+    asio::ip::udp::endpoint sender_endpoint;
+    iovec iov;
+    iov.iov_base = recv_buf;
+    iov.iov_len = raw_pool_.BLOCK_SIZE;
+    alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+    msghdr message = {};
+    message.msg_name = sender_endpoint.data();
+    message.msg_namelen = static_cast<socklen_t>(sender_endpoint.capacity());
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    const ssize_t bytes_transferred = recvmsg(socket_->native_handle(), &message, MSG_DONTWAIT);
+    if (bytes_transferred < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        std::cerr << "Receive error: " << std::strerror(errno) << std::endl;
+      }
+      return false;
+    }
+    sender_endpoint.resize(message.msg_namelen);
+
+    kernel_time_ = std::chrono::system_clock::time_point();
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET) continue;
+      if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        timespec time;
+        std::memcpy(&time, CMSG_DATA(cmsg), sizeof(time));
+        kernel_time_ = std::chrono::system_clock::time_point(
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)));
+        socket_queue_time_.Record(__Nanoseconds(std::chrono::system_clock::now() - kernel_time_));
+      } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+        // Drops since the socket was created; only sent along once there is one
+        uint32_t socket_drops;
+        std::memcpy(&socket_drops, CMSG_DATA(cmsg), sizeof(socket_drops));
+        kernel_drops_.Add(socket_drops - socket_drops_);
+        socket_drops_ = socket_drops;
+      }
+    }
+
+    __HandleDatagram(sender_endpoint, recv_buf, static_cast<size_t>(bytes_transferred));
+    return true;
+  }
+}
+#endif
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__HandleDatagram(const asio::ip::udp::endpoint& sender_endpoint,
+                                                              uint8_t* recv_buf,
+                                                              const size_t size) {
+  bytes_received_.Add(size);
+  if (capture_) {
+    const std::chrono::system_clock::time_point arrival =
+      kernel_time_ != std::chrono::system_clock::time_point() ? kernel_time_ : std::chrono::system_clock::now();
+    capture_->Write(arrival, sender_endpoint, capture_endpoint_, recv_buf, size);
+  }
+  if (size < CHUNKHEADER_SIZE) {
+    malformed_packets_.Add();
+  } else {
+    try {
+      __HandlePacket(sender_endpoint, recv_buf, size);
+    } catch (const std::error_code& error) {
+      std::cerr << "Handling packet error(" << error << "): " << error.message() << std::endl;
+    }
+  }
+  // Counted once handled, so that a count reaching the number of injected datagrams means all were
+  packets_received_.Add();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__HandlePacket(const asio::ip::udp::endpoint& sender_endpoint,
+                                                            uint8_t* recv_buf,
+                                                            const size_t size) {
+
+  ChunkHeader header;
+  std::memcpy(&header, recv_buf, CHUNKHEADER_SIZE);
+
+  NetworkToHost(&header);
+
+  // Drop malformed packets before they touch any frame buffer
+  if (header.total_chunks == 0
+      || header.chunk_index >= header.total_chunks
+      || header.total_chunks != LAYOUT.ChunkCount(header.total_size)
+      || LAYOUT.ChunkOffset(header.chunk_index) + header.chunk_size > header.total_size
+      || header.chunk_size > LAYOUT.PAYLOAD
+      || size < CHUNKHEADER_SIZE + static_cast<size_t>(header.chunk_size)) {
+    malformed_packets_.Add();
+    return;
+  }
+  CHUNKSTREAM_PROBE5(receive_packet, header.id, header.chunk_index, header.total_chunks,
+                     header.chunk_size, header.total_size);
+
+  // Stragglers of frames superseded by a newer completed frame
+  if (latest_only_ && has_latest_id_ && static_cast<int32_t>(header.id - latest_id_) <= 0) {
+    late_chunks_.Add();
+    return;
+  }
+
+  // Stragglers of frames skipped by ordered delivery
+  if (ordered_window_ > 0 && has_next_id_ && static_cast<int32_t>(header.id - next_id_) < 0
+      && !assembling_queue_.find(header.id)) {
+    late_chunks_.Add();
+    return;
+  }
+
+  // Stragglers of frames which were completed or dropped, and may be released already
+  if (!assembling_queue_.find(header.id) && __IsFinished(header.id)) {
+    late_chunks_.Add();
+    return;
+  }
+
+  if (assembling_queue_.empty()
+      || (!assembling_queue_.find(header.id) &&
+         header.transmission_type == 0)) {
+
+    // Buffering
+    for (const uint32_t dropped_id : dropped_queue_) {
+      __ReleaseFrame(dropped_id);
+    }
+    dropped_queue_.clear();
+
+    uint8_t* data_pool_starting = data_pool_.Acquire(header.total_size);
+    Frame* frame_ptr = data_pool_starting ? __AcquireFrame() : nullptr;
+
+    if (frame_ptr) {
+      if (ordered_window_ > 0 && !has_next_id_) {
+        next_id_ = header.id;
+        has_next_id_ = true;
+      }
+      frame_ptr->Reset(sender_endpoint, header.id, header.total_chunks, header.total_size, data_pool_starting);
+
+      // Push new frame
+      assembling_queue_.push_back(header.id, frame_ptr);
+
+      // Push chunk to the frame
+      frame_ptr->SetKernelArrival(kernel_time_, kernel_drops_.Get());
+      frame_ptr->AddChunk(header, recv_buf + CHUNKHEADER_SIZE);
+    } else {
+      data_pool_.Release(data_pool_starting);
+      no_buffer_chunks_.Add();
+
+      // Buffer is full or the frame is too large, drop packet
+      std::cerr << "Receive error: Buffer overflow; bigger buffer_size or max_data_size is required" << std::endl;
+    }
+  } else {
+    Frame** frame_ptr = assembling_queue_.find(header.id);
+    if (!frame_ptr || !*frame_ptr || (*frame_ptr)->IsTimeout()
+        || (*frame_ptr)->GetStatus() != Frame::ASSEMBLING) {
+      // Drop packet
+      late_chunks_.Add();
+    } else if ((*frame_ptr)->IsChunkAdded(header.chunk_index)) {
+      duplicate_chunks_.Add();
+    } else {
+      // Push chunk to the frame
+      (*frame_ptr)->SetKernelArrival(kernel_time_, kernel_drops_.Get());
+      (*frame_ptr)->AddChunk(header, recv_buf + CHUNKHEADER_SIZE);
+    }
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__RequestResend(const ChunkHeader header, const asio::ip::udp::endpoint endpoint) {
+  CHUNKSTREAM_PROBE3(resend_request, header.id, header.chunk_index, header.total_chunks);
+  const ChunkHeader n_header = HostToNetwork(header);
+  uint8_t* data = resend_pool_.Acquire();
+  std::memcpy(data, &n_header, CHUNKHEADER_SIZE);
+  try {
+    size_t len = socket_->send_to(
+      asio::buffer(data, CHUNKHEADER_SIZE),
+      endpoint
+    );
+    resend_requests_sent_.Add();
+    bytes_sent_.Add(len);
+  } catch (const std::error_code& error) {
+    if (error) {
+      std::cerr << "Send request error(" << error << "): " << error.message() << std::endl;
+    }
+  }
+  resend_pool_.Release(data);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__FrameGrabbed(Frame* frame) {
+  const uint32_t id = frame->GetId();
+  uint8_t* data = frame->GetData();
+  const size_t size = frame->GetTotalSize();
+  if (!data || size <= 0) {
+    return; // error condition
+  }
+  __FrameFinished(id);
+  assembled_count_.Add();
+  const uint64_t assembly_ns = __Nanoseconds(frame->GetCompletedTime() - frame->GetFirstChunkTime());
+  assembly_time_.Record(assembly_ns);
+  CHUNKSTREAM_PROBE4(frame_ready, id, size, frame->GetResendRounds(), assembly_ns);
+  if (recorder_) {
+    recorder_->Record(FlightRecorder::FRAME_READY, id, 0, stream_);
+  }
+  resend_rounds_.Record(frame->GetResendRounds());
+  if (frame->GetResendRounds() > 0) {
+    resend_recovery_time_.Record(__Nanoseconds(frame->GetCompletedTime() - frame->GetFirstResendTime()));
+  }
+  if (latest_only_) {
+    if (!has_latest_id_ || static_cast<int32_t>(id - latest_id_) > 0) {
+      latest_id_ = id;
+      has_latest_id_ = true;
+    }
+    __AbandonOlderFrames(id);
+  }
+  if (ordered_window_ > 0) {
+    auto position = std::upper_bound(held_frames_.begin(), held_frames_.end(), id,
+      [](const uint32_t id, const Frame* held) { return static_cast<int32_t>(id - held->GetId()) < 0; });
+    held_frames_.insert(position, frame);
+    __DeliverHeldFrames();
+    return;
+  }
+  __DeliverFrame(frame);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__DeliverFrame(Frame* frame) {
+  const uint32_t id = frame->GetId();
+  uint8_t* data = frame->GetData();
+  const size_t size = frame->GetTotalSize();
+  bool has_handler = true;
+  if constexpr (std::is_constructible_v<bool, const Handler&>) {
+    has_handler = static_cast<bool>(grabbed_);
+  }
+  if (!has_handler) {
+    __ReleaseFrame(id);
+    return;
+  }
+  frame->SetDeliveredTime(std::chrono::steady_clock::now());
+  if (recorder_) {
+    recorder_->Record(FlightRecorder::FRAME_GRABBED, id, 0, stream_);
+  }
+  // Delegate responsibility for freeing buffers to the user
+  if constexpr (std::is_invocable_v<Handler&, FrameView>) {
+    grabbed_(FrameView(this, &BasicReceiver::__ReleaseFrameView, id, data, size,
+                       frame->GetFirstChunkTime(), frame->GetCompletedTime(),
+                       frame->GetFirstChunkKernelTime(), frame->GetCompletedKernelTime(),
+                       frame->GetKernelDrops()));
+  } else {
+    std::vector<uint8_t> buffer(data, data + size);
+    grabbed_(std::move(buffer), Releaser(this, id));
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__FrameProgress(Frame* frame, const size_t previous_ready_size) {
+  if (!progress_) return;
+  const size_t ready_size = frame->GetReadySize();
+  const size_t total_size = frame->GetTotalSize();
+  if (ready_size < total_size && progress_step_ > 0
+      && ready_size / progress_step_ == previous_ready_size / progress_step_) {
+    return;
+  }
+  progress_(frame->GetId(), frame->GetData(), ready_size, total_size);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__DeliverHeldFrames() {
+  size_t delivered = 0;
+  while (delivered < held_frames_.size()) {
+    Frame* front = held_frames_[delivered];
+    const uint32_t front_id = front->GetId();
+    if (static_cast<int32_t>(front_id - next_id_) > 0) {
+      // Frames in front of it which can still complete
+      bool blocked = false;
+      assembling_queue_.for_each([this, front_id, &blocked](const uint32_t other_id, Frame* other) {
+        if (other->GetStatus() == Frame::ASSEMBLING
+            && static_cast<int32_t>(other_id - next_id_) >= 0
+            && static_cast<int32_t>(other_id - front_id) < 0) {
+          blocked = true;
+        }
+      });
+      if (held_frames_.size() - delivered <= ordered_window_) {
+        // An assembling frame completes or times out by itself; a frame of which no chunk
+        // arrived yet is waited for until the gap expires
+        if (blocked) {
+          break;
+        }
+        const std::chrono::steady_clock::time_point expiry = front->GetCompletedTime() + gap_timeout_;
+        if (std::chrono::steady_clock::now() < expiry) {
+          __WaitGap(expiry);
+          break;
+        }
+      }
+      if (blocked) {
+        // Window is exceeded; give up on the frames in front
+        __AbandonOlderFrames(front_id);
+      }
+    }
+    if (static_cast<int32_t>(front_id + 1 - next_id_) > 0) {
+      next_id_ = front_id + 1;
+    }
+    delivered++;
+    __DeliverFrame(front);
+  }
+  held_frames_.erase(held_frames_.begin(), held_frames_.begin() + delivered);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__WaitGap(const std::chrono::steady_clock::time_point expiry) {
+  if (gap_expiry_ == expiry) {
+    return;
+  }
+  gap_expiry_ = expiry;
+  gap_timer_.expires_at(expiry);
+  pending_receives_.Add();
+  gap_timer_.async_wait([this, expiry](const std::error_code& error) {
+    // Superseded by a later gap, or cancelled
+    if (!error && running_ && gap_expiry_ == expiry) {
+      gap_expiry_ = std::chrono::steady_clock::time_point();
+      __DeliverHeldFrames();
+    }
+    pending_receives_.Done();
+  });
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__FrameDropped(const uint32_t id, uint8_t*) {
+  dropped_queue_.push_back(id);
+  timed_out_count_.Add();
+  __FrameFinished(id);
+  if (ordered_window_ > 0 && !held_frames_.empty()) {
+    __DeliverHeldFrames();
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__AbandonOlderFrames(const uint32_t id) {
+  abandoned_frames_.clear();
+  assembling_queue_.for_each([this, id](const uint32_t other_id, Frame* other) {
+    if (other->GetStatus() == Frame::ASSEMBLING && static_cast<int32_t>(other_id - id) < 0) {
+      abandoned_frames_.emplace_back(other_id, other);
+    }
+  });
+  for (const std::pair<uint32_t, Frame*>& abandoned : abandoned_frames_) {
+    abandoned.second->Abandon();
+    __ReleaseFrame(abandoned.first);
+    abandoned_count_.Add();
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__FrameFinished(const uint32_t id) {
+  finished_ids_[finished_id_next_].id = id;
+  finished_ids_[finished_id_next_].time = std::chrono::steady_clock::now();
+  finished_id_next_ = (finished_id_next_ + 1) % finished_ids_.size();
+}
+
+template<typename Handler, typename Layout, typename Socket>
+bool BasicReceiver<Handler, Layout, Socket>::__IsFinished(const uint32_t id) const {
+  // Expired entries are ignored, as a restarted sender numbers its frames from 0 again
+  const std::chrono::steady_clock::time_point oldest = std::chrono::steady_clock::now() - FINISHED_ID_TIMEOUT;
+  for (const FinishedId& finished : finished_ids_) {
+    if (finished.id == id && finished.time != std::chrono::steady_clock::time_point()
+        && finished.time > oldest) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__ReleaseFrame(const uint32_t id) {
+  std::optional<Frame*> frame = assembling_queue_.extract(id);
+  if (!frame) return;
+  const std::chrono::steady_clock::time_point delivered_time = (*frame)->GetDeliveredTime();
+  if (delivered_time != std::chrono::steady_clock::time_point()) {
+    hold_time_.Record(__Nanoseconds(std::chrono::steady_clock::now() - delivered_time));
+    if (recorder_) {
+      recorder_->Record(FlightRecorder::FRAME_RELEASED, id, 0, stream_);
+    }
+  }
+  data_pool_.Release((*frame)->GetData());
+  __RecycleFrame(*frame);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__ReleaseFrameView(void* receiver, const uint32_t id) {
+  static_cast<BasicReceiver*>(receiver)->__ReleaseFrame(id);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+typename BasicReceiver<Handler, Layout, Socket>::Frame* BasicReceiver<Handler, Layout, Socket>::__AcquireFrame() {
+  std::lock_guard<std::mutex> lock(frames_mutex_);
+  if (free_frames_.empty()) {
+    return nullptr;
+  }
+  Frame* frame = free_frames_.back();
+  free_frames_.pop_back();
+  return frame;
+}
+
+template<typename Handler, typename Layout, typename Socket>
+void BasicReceiver<Handler, Layout, Socket>::__RecycleFrame(Frame* frame) {
+  std::lock_guard<std::mutex> lock(frames_mutex_);
+  free_frames_.push_back(frame);
+}
+
+template<typename Handler, typename Layout, typename Socket>
+FrameQueue* BasicReceiver<Handler, Layout, Socket>::__GetFrameQueue() {
+  if constexpr (std::is_same_v<Handler, std::reference_wrapper<FrameQueue>>) {
+    return &grabbed_.get();
+  } else {
+    return nullptr;
+  }
+}
+
+template<typename Handler, typename Layout, typename Socket>
+uint64_t BasicReceiver<Handler, Layout, Socket>::__Nanoseconds(const std::chrono::steady_clock::duration duration) {
+  const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+}
+
+// Type-erased callback of `Receiver`
+using GrabCallback = std::function<void(const std::vector<uint8_t>& data, std::function<void()> Release)>;
+
+using Receiver = BasicReceiver<GrabCallback>;
+using ReceivingFrame = Receiver::Frame;
+
+// Type-erased callback of `ZeroCopyReceiver`; the frame is released when `frame` is destroyed
+using FrameViewCallback = std::function<void(FrameView frame)>;
+
+using ZeroCopyReceiver = BasicReceiver<FrameViewCallback>;
+
+// Queues assembled frames for `FrameQueue::TryReceive()`/`Receive()`, so that the network
+// thread never runs user code. Construct it with `std::ref(queue)`; the queue must outlive it.
+using PullReceiver = BasicReceiver<std::reference_wrapper<FrameQueue>>;
+
+// Hands assembled frames to the worker threads of a `Dispatcher`.
+// Construct it with `std::ref(dispatcher)`; the dispatcher must outlive it.
+using DispatchReceiver = BasicReceiver<std::reference_wrapper<Dispatcher>>;
+
+// `ZeroCopyReceiver` on a `SimulatedLink` instead of UDP
+using SimulatedReceiver = BasicReceiver<FrameViewCallback, DynamicLayout, SimulatedSocket>;
+
+// Instantiated once in the library
+extern template class BasicReceivingFrame<Receiver>;
+extern template class BasicReceiver<GrabCallback>;
+extern template class BasicReceivingFrame<ZeroCopyReceiver>;
+extern template class BasicReceiver<FrameViewCallback>;
+extern template class BasicReceivingFrame<PullReceiver>;
+extern template class BasicReceiver<std::reference_wrapper<FrameQueue>>;
+extern template class BasicReceivingFrame<DispatchReceiver>;
+extern template class BasicReceiver<std::reference_wrapper<Dispatcher>>;
+extern template class BasicReceivingFrame<SimulatedReceiver>;
+extern template class BasicReceiver<FrameViewCallback, DynamicLayout, SimulatedSocket>;
+
 }
 
-#endif
\ No newline at end of file
+#endif
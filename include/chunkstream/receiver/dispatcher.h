@@ -0,0 +1,94 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_RECEIVER_DISPATCHER_H_
+#define CHUNKSTREAM_RECEIVER_DISPATCHER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chunkstream/receiver/frame_queue.h"
+#include "chunkstream/receiver/frame_view.h"
+
+namespace chunkstream {
+
+// Runs the frame handler on worker threads instead of the network thread.
+// Pass it to one or more receivers as `std::ref(dispatcher)` (see `DispatchReceiver`).
+// All frames of one receiver go to the same worker, so each stream is handled in order,
+// while different streams are handled in parallel.
+class Dispatcher {
+public:
+  using Handler = std::function<void(FrameView frame)>;
+
+  // Time frames spent in the worker queues, from assembly to the start of their handler
+  struct QueueWait {
+    size_t count;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds max;
+  };
+
+public:
+  // @param worker_count Number of worker threads, each with its own queue
+  // @param queue_capacity Maximum number of frames waiting for one worker
+  // @param policy What to do when a worker's queue is full
+  Dispatcher(Handler handler,
+             const size_t worker_count,
+             const size_t queue_capacity = 16,
+             const FrameQueue::OverflowPolicy policy = FrameQueue::DROP_OLDEST);
+  Dispatcher(const Dispatcher&) = delete;
+  Dispatcher& operator=(const Dispatcher&) = delete;
+  ~Dispatcher();
+
+  // Called by the receiver for every assembled frame
+  void operator()(FrameView frame);
+
+  // Joins the workers; queued frames are released without being handled.
+  void Stop();
+
+  // Releases the queued frames of one receiver and waits until none of its frames is being handled.
+  // Called by the receiver's destructor.
+  void Clear(const void* source);
+
+  size_t GetWorkerCount() const;
+
+  // Queue of one worker, e.g. for its overflow counters
+  const FrameQueue& GetQueue(const size_t worker) const;
+
+  QueueWait GetQueueWait() const;
+
+public:
+  const size_t WORKER_COUNT;
+
+private:
+  struct Worker {
+    Worker(const size_t queue_capacity, const FrameQueue::OverflowPolicy policy)
+      : queue(queue_capacity, policy) {}
+
+    FrameQueue queue;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable frame_done; // Notified when `active_source` is reset
+    const void* active_source = nullptr; // Source of the frame being handled; set under the queue lock
+  };
+
+  void __Run(Worker* worker);
+  size_t __WorkerIndex(const void* source) const;
+
+private:
+  Handler handler_;
+  std::vector< std::unique_ptr<Worker> > workers_;
+  std::atomic_bool running_ = true;
+
+  std::atomic<size_t> wait_count_ = 0;
+  std::atomic<int64_t> wait_total_ns_ = 0;
+  std::atomic<int64_t> wait_max_ns_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_RECEIVER_FRAME_QUEUE_H_
+#define CHUNKSTREAM_RECEIVER_FRAME_QUEUE_H_
+
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <vector>
+#include "chunkstream/core/completion_handler.h"
+#include "chunkstream/receiver/frame_view.h"
+
+namespace chunkstream {
+
+// Bounded ring of assembled frames between the network thread and consumers.
+// Pass it to a receiver as `std::ref(queue)` (see `PullReceiver`); the network thread only
+// pushes views, and consumers pull them with `TryReceive()`, `Receive()` or `AsyncReceive()`.
+// Queued frames still occupy the receiver's frame store, so a capacity above
+// the receiver's `buffer_size` has no effect.
+class FrameQueue {
+public:
+  enum OverflowPolicy {
+    DROP_OLDEST, // Releases the oldest queued frame to make room
+    DROP_NEWEST, // Releases the incoming frame
+    BLOCK        // Blocks the network thread until a consumer takes a frame
+  };
+
+public:
+  // @param capacity Maximum number of frames waiting for consumers
+  FrameQueue(const size_t capacity, const OverflowPolicy policy = DROP_OLDEST);
+  FrameQueue(const FrameQueue&) = delete;
+  FrameQueue& operator=(const FrameQueue&) = delete;
+
+  // Completes pending `AsyncReceive()` operations with `asio::error::operation_aborted`
+  ~FrameQueue();
+
+  // Called by the receiver for every assembled frame
+  void operator()(FrameView frame);
+
+  // @return The oldest frame, or an empty view if no frame is queued
+  FrameView TryReceive();
+
+  // @return The oldest frame, or an empty view if none arrived within `timeout` or the queue was closed
+  FrameView Receive(const std::chrono::milliseconds timeout);
+
+  // Like `Receive()`, and stores the source of the frame in `popped_source`, guarded by `source_mutex`,
+  // under the queue lock, so that a `Clear(source)` cannot miss a frame on its way to a consumer.
+  FrameView Receive(const std::chrono::milliseconds timeout, std::mutex& source_mutex, const void*& popped_source);
+
+  // Waits for the next frame without blocking a thread, e.g.
+  // `FrameView frame = co_await queue.AsyncReceive(asio::use_awaitable);`
+  // Completes as `void(std::error_code, FrameView)` on the handler's associated executor,
+  // with `asio::error::operation_aborted` once the queue is closed.
+  template<typename CompletionToken>
+  auto AsyncReceive(CompletionToken&& token);
+
+  // Wakes all waiting consumers and producers, and aborts pending `AsyncReceive()` operations;
+  // frames pushed afterwards are released at once.
+  void Close();
+
+  // Reopens the queue after `Close()`
+  void Open();
+
+  // Releases all queued frames
+  void Clear();
+
+  // Releases the queued frames of one receiver, see `FrameView::GetSource()`
+  void Clear(const void* source);
+
+  size_t GetSize() const;
+
+  // Frames pushed by the receiver, including dropped ones
+  size_t GetPushCount() const;
+
+  // Frames released by DROP_OLDEST
+  size_t GetDropOldestCount() const;
+
+  // Frames released by DROP_NEWEST, or pushed while the queue was closed
+  size_t GetDropNewestCount() const;
+
+  // Pushes which had to wait for a consumer under BLOCK
+  size_t GetBlockCount() const;
+
+public:
+  const size_t CAPACITY;
+  const OverflowPolicy POLICY;
+
+private:
+  using ReceiveHandler = CompletionHandler<std::error_code, FrameView>;
+
+  void __AsyncReceive(ReceiveHandler handler);
+
+  // Must be called with `mutex_` held and a frame queued
+  FrameView __Pop();
+
+private:
+  std::vector<FrameView> ring_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  bool closed_ = false;
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  // Pending `AsyncReceive()` operations; only non-empty while no frame is queued
+  std::deque<ReceiveHandler> waiters_;
+
+  std::atomic<size_t> push_count_ = 0;
+  std::atomic<size_t> drop_oldest_count_ = 0;
+  std::atomic<size_t> drop_newest_count_ = 0;
+  std::atomic<size_t> block_count_ = 0;
+};
+
+template<typename CompletionToken>
+auto FrameQueue::AsyncReceive(CompletionToken&& token) {
+  return asio::async_initiate<CompletionToken, void(std::error_code, FrameView)>(
+    [this](auto handler) {
+      __AsyncReceive(ReceiveHandler(std::move(handler)));
+    },
+    token
+  );
+}
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_RECEIVER_FRAME_VIEW_H_
+#define CHUNKSTREAM_RECEIVER_FRAME_VIEW_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace chunkstream {
+
+// Move-only handle of an assembled frame which still lives in the receiver's frame store.
+// The frame is released back to the receiver when the view is destroyed or `Release()` is called,
+// so the data must not be used after that.
+class FrameView {
+public:
+  using Clock = std::chrono::steady_clock;
+  using KernelClock = std::chrono::system_clock;
+
+  // @param release Called once with `owner` and `id` when the view releases the frame
+  using ReleaseFunction = void (*)(void* owner, const uint32_t id);
+
+public:
+  FrameView() = default;
+  FrameView(void* owner,
+            ReleaseFunction release,
+            const uint32_t id,
+            const uint8_t* data,
+            const size_t size,
+            const Clock::time_point first_chunk_time,
+            const Clock::time_point completed_time,
+            const KernelClock::time_point first_chunk_kernel_time = KernelClock::time_point(),
+            const KernelClock::time_point completed_kernel_time = KernelClock::time_point(),
+            const uint64_t kernel_drops = 0);
+  FrameView(FrameView&& other) noexcept;
+  FrameView& operator=(FrameView&& other) noexcept;
+  FrameView(const FrameView&) = delete;
+  FrameView& operator=(const FrameView&) = delete;
+  ~FrameView();
+
+  // Gives the frame back to the receiver before the view is destroyed
+  void Release();
+
+  const uint8_t* GetData() const;
+  size_t GetSize() const;
+  uint32_t GetId() const;
+
+  // Receiver which assembled the frame; identifies the stream the frame belongs to
+  const void* GetSource() const;
+
+  // Arrival of the first chunk of the frame
+  Clock::time_point GetFirstChunkTime() const;
+
+  // Arrival of the chunk which completed the frame
+  Clock::time_point GetCompletedTime() const;
+
+  // Kernel timestamps of the same chunks, taken when the datagrams reached the socket;
+  // the epoch unless the receiver has kernel timestamps enabled
+  KernelClock::time_point GetFirstChunkKernelTime() const;
+  KernelClock::time_point GetCompletedKernelTime() const;
+
+  // Datagrams the kernel dropped for a full socket buffer while the frame was assembling,
+  // which tells socket overruns apart from loss on the network
+  uint64_t GetKernelDrops() const;
+
+  // False if the view is empty or already released
+  explicit operator bool() const;
+
+private:
+  void* owner_ = nullptr;
+  ReleaseFunction release_ = nullptr;
+  uint32_t id_ = 0;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  Clock::time_point first_chunk_time_;
+  Clock::time_point completed_time_;
+  KernelClock::time_point first_chunk_kernel_time_;
+  KernelClock::time_point completed_kernel_time_;
+  uint64_t kernel_drops_ = 0;
+};
+
+}
+
+#endif
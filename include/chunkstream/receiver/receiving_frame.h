@@ -4,70 +4,529 @@
 #ifndef CHUNKSTREAM_RECEIVER_RECEIVING_FRAME_H_
 #define CHUNKSTREAM_RECEIVER_RECEIVING_FRAME_H_
 
+#include <algorithm>
 #include <asio.hpp>
+#include <iostream>
 #include "chunkstream/core/chunk_header.h"
+#include "chunkstream/core/flight_recorder.h"
+#include "chunkstream/core/handler_memory.h"
+#include "chunkstream/core/pending_count.h"
+#include "chunkstream/core/trace.h"
 
 namespace chunkstream {
 
-class ReceivingFrame {
+// @tparam Owner Receiver type which assembled/dropped/resend events are dispatched to.
+//               It must provide `__RequestResend(header, endpoint)`, `__FrameGrabbed(frame)`,
+//               `__FrameProgress(frame, previous_ready_size)` and `__FrameDropped(id, data)`,
+//               which are called directly so the compiler can inline them.
+//               Its `LayoutType` decides where each chunk is placed in the frame.
+template<typename Owner>
+class BasicReceivingFrame {
 public:
+  using Layout = typename Owner::LayoutType;
+
   enum Status {
-    ASSEMBLING, 
-    DROPPED, 
+    ASSEMBLING,
+    DROPPED,
     READY
   };
 public:
-  // @memory_pool requires its size as `total_chunks * chunk_size` 
-  // @param send_assembled_callback `_1` for data ptr, `_2` for size of the data 
-  ReceivingFrame(std::shared_ptr<asio::io_context> io_context, 
-                const asio::ip::udp::endpoint sender_endpoint, 
-                const uint32_t id, 
-                const size_t total_chunks, 
-                uint8_t* memory_pool,
-                const size_t memory_pool_block_size,
-                std::function<void(const ChunkHeader header, 
-                                   const asio::ip::udp::endpoint endpoint)> request_resend_func,
-                std::function<void(const uint32_t id, 
-                                   uint8_t* data, 
-                                   const size_t size)> send_assembled_callback, 
-                std::function<void(const uint32_t id, uint8_t* data)> dropped_callback);
+  // Frames are constructed once by the receiver and reused through `Reset()`.
+  // @param executor Executor of the timers; handlers of one receiver must not run concurrently
+  // @param owner Receiver which receives assembled/dropped/resend events of this frame
+  BasicReceivingFrame(const asio::any_io_executor& executor,
+                      const Layout& layout,
+                      Owner* owner);
+
+  // Starts assembling a new frame. Timers of the previous frame are cancelled and
+  // their pending handlers are ignored.
+  // @memory_pool requires its size as `total_size`
+  void Reset(const asio::ip::udp::endpoint sender_endpoint,
+             const uint32_t id,
+             const size_t total_chunks,
+             const size_t total_size,
+             uint8_t* memory_pool);
+
+  // Cancels the timers of the frame before it goes back to the pool.
+  void Cancel();
+
+  // Gives up assembling: cancels the timers and ignores further chunks.
+  void Abandon();
+
+  // Drops frames which are not complete `deadline` after their first chunk, or 0 for no deadline.
+  // Takes effect from the next `Reset()`.
+  void SetDeadline(const std::chrono::milliseconds deadline);
+
+  // Records the lifecycle events of the frame in `recorder`, or nullptr to stop recording
+  void SetFlightRecorder(FlightRecorder* recorder, const uint8_t stream);
+
+  // Blocks until the handlers of all timer waits have run, including cancelled ones
+  void WaitPendingWaits();
 
   bool IsChunkAdded(const uint16_t chunk_index);
   bool IsTimeout();
 
   // @data should be `recv_buffer_.data() + CHUNKHEADER_SIZE`
+  // Chunks whose size does not match this frame are ignored.
   void AddChunk(const ChunkHeader& header, uint8_t* data);
   int GetStatus();
   uint8_t* GetData();
+  uint32_t GetId() const;
+  size_t GetTotalSize() const;
+
+  // Size of the contiguous prefix of the frame whose chunks have all been copied
+  size_t GetReadySize() const;
+
+  // Arrival of the first chunk, i.e. the last `Reset()`
+  std::chrono::steady_clock::time_point GetFirstChunkTime() const;
+
+  // Arrival of the chunk which completed the frame
+  std::chrono::steady_clock::time_point GetCompletedTime() const;
+
+  // Number of times missing chunks were requested since the last `Reset()`
+  size_t GetResendRounds() const;
+
+  // First resend request of the frame; valid if `GetResendRounds() > 0`
+  std::chrono::steady_clock::time_point GetFirstResendTime() const;
+
+  // Set by the receiver when the frame is handed to its handler; cleared by `Reset()`
+  void SetDeliveredTime(const std::chrono::steady_clock::time_point time);
+  std::chrono::steady_clock::time_point GetDeliveredTime() const;
+
+  // Set by the receiver before each chunk is added, from the datagram's kernel timestamp
+  // and its count of socket buffer drops so far; cleared by `Reset()`
+  void SetKernelArrival(const std::chrono::system_clock::time_point time, const uint64_t kernel_drops);
+
+  // Kernel arrival of the first chunk and of the chunk which completed the frame,
+  // or the epoch without kernel timestamps
+  std::chrono::system_clock::time_point GetFirstChunkKernelTime() const;
+  std::chrono::system_clock::time_point GetCompletedKernelTime() const;
+
+  // Datagrams dropped by the kernel between the first and the last chunk of the frame
+  uint64_t GetKernelDrops() const;
 
 private:
-  void __RequestResend(const uint32_t id);
+  // Waits until INIT_CHUNK_TIMEOUT passed since the last INIT chunk, then starts requesting resends.
+  void __WaitInitChunk(const uint32_t generation);
+  // Drops the frame at `expiry` unless it is completed or reused before
+  void __WaitFrameDrop(const uint32_t generation, const std::chrono::steady_clock::time_point expiry);
+  void __RequestResend(const uint32_t id, const uint32_t generation);
 
-public: 
-  const uint32_t ID;
+public:
+  const Layout LAYOUT;
   const size_t BLOCK_SIZE;
   const std::chrono::milliseconds INIT_CHUNK_TIMEOUT;
-  const std::chrono::milliseconds FRAME_DROP_TIMEOUT; 
+  const std::chrono::milliseconds FRAME_DROP_TIMEOUT;
   const std::chrono::milliseconds RESEND_TIMEOUT;
 
 private:
   asio::ip::udp::endpoint SENDER_ENDPOINT;
-  std::shared_ptr<asio::io_context> io_context_;
-  std::function<void(const ChunkHeader header, const asio::ip::udp::endpoint endpoint)> __RequestResendCallback;
-  std::function<void(const uint32_t id, uint8_t* data, const size_t size)> __SendAssembledCallback;
-  std::function<void(const uint32_t id, uint8_t* data)> __DroppedCallback;
+  Owner* owner_;
   asio::steady_timer init_chunk_timer_;
   asio::steady_timer frame_drop_timer_;
   asio::steady_timer resend_timer_;
+  // Waits of the three timers, including cancelled ones still queued
+  HandlerMemory<256, 6> timer_handler_memory_;
+  PendingCount pending_waits_;
+  // Per-chunk bookkeeping is one bit, so even 65,535 chunks stay within 8 KB
   std::vector<bool> chunk_bitmap_;
   std::mutex chunk_bitmap_mutex_;
-  std::vector<ChunkHeader> chunk_headers_;
-  uint8_t* data_;
+  size_t received_chunks_ = 0;
+  size_t contiguous_chunks_ = 0; // Chunks [0, contiguous_chunks_) are all copied
+  size_t total_size_ = 0;
+  size_t last_chunk_size_ = 0;
+  uint8_t* data_ = nullptr;
+  uint32_t id_ = 0;
+  std::atomic<uint32_t> generation_ = 0; // Increased on each `Reset()`
+  std::chrono::milliseconds deadline_ = std::chrono::milliseconds(0);
+  FlightRecorder* recorder_ = nullptr;
+  uint8_t stream_ = 0;
+  std::chrono::steady_clock::time_point first_chunk_time_;
+  std::chrono::steady_clock::time_point completed_time_;
+  std::chrono::steady_clock::time_point last_init_chunk_time_;
+  std::chrono::steady_clock::time_point first_resend_time_;
+  std::chrono::steady_clock::time_point delivered_time_;
+  std::chrono::system_clock::time_point first_chunk_kernel_time_;
+  std::chrono::system_clock::time_point completed_kernel_time_;
+  uint64_t first_kernel_drops_ = 0;
+  uint64_t last_kernel_drops_ = 0;
+  bool has_kernel_arrival_ = false;
+  size_t resend_rounds_ = 0;
+  bool init_chunk_timer_armed_ = false;
   std::atomic_bool request_resend_ = false;
   std::atomic_bool request_timeout_ = false;
   std::atomic_int status_;
 };
 
+template<typename Owner>
+BasicReceivingFrame<Owner>::BasicReceivingFrame(
+  const asio::any_io_executor& executor,
+  const Layout& layout,
+  Owner* owner)
+: LAYOUT(layout),
+  BLOCK_SIZE(LAYOUT.PAYLOAD),
+  INIT_CHUNK_TIMEOUT(20),
+  FRAME_DROP_TIMEOUT(100),
+  RESEND_TIMEOUT(20),
+  owner_(owner),
+  init_chunk_timer_(executor),
+  frame_drop_timer_(executor),
+  resend_timer_(executor),
+  status_(DROPPED) {
+
+  assert(owner);
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::Reset(const asio::ip::udp::endpoint sender_endpoint,
+                                       const uint32_t id,
+                                       const size_t total_chunks,
+                                       const size_t total_size,
+                                       uint8_t* memory_pool) {
+  assert(memory_pool);
+  Cancel();
+  {
+    std::lock_guard<std::mutex> lock(chunk_bitmap_mutex_);
+    SENDER_ENDPOINT = sender_endpoint;
+    id_ = id;
+    // Keeps its capacity, so reuse does not allocate once warmed up
+    chunk_bitmap_.assign(total_chunks, false);
+    received_chunks_ = 0;
+    contiguous_chunks_ = 0;
+    total_size_ = total_size;
+    last_chunk_size_ = total_size - LAYOUT.ChunkOffset(total_chunks - 1);
+    data_ = memory_pool;
+    first_chunk_time_ = std::chrono::steady_clock::now();
+    resend_rounds_ = 0;
+    delivered_time_ = std::chrono::steady_clock::time_point();
+    first_chunk_kernel_time_ = std::chrono::system_clock::time_point();
+    completed_kernel_time_ = std::chrono::system_clock::time_point();
+    first_kernel_drops_ = 0;
+    last_kernel_drops_ = 0;
+    has_kernel_arrival_ = false;
+    request_resend_ = false;
+    request_timeout_ = false;
+    status_ = ASSEMBLING;
+  }
+  if (recorder_) {
+    recorder_->Record(FlightRecorder::FRAME_CREATED, id, static_cast<uint16_t>(total_chunks), stream_);
+  }
+  if (deadline_.count() > 0) {
+    __WaitFrameDrop(generation_, first_chunk_time_ + deadline_);
+  }
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::Cancel() {
+  generation_++;
+  request_resend_ = false;
+  init_chunk_timer_armed_ = false;
+  init_chunk_timer_.cancel();
+  frame_drop_timer_.cancel();
+  resend_timer_.cancel();
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::Abandon() {
+  CHUNKSTREAM_PROBE4(frame_drop, id_, total_size_, received_chunks_, 1);
+  if (recorder_) {
+    recorder_->Record(FlightRecorder::FRAME_DROPPED, id_, 1, stream_);
+  }
+  Cancel();
+  request_timeout_ = true;
+  status_ = DROPPED;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::SetDeadline(const std::chrono::milliseconds deadline) {
+  deadline_ = deadline;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::SetFlightRecorder(FlightRecorder* recorder, const uint8_t stream) {
+  recorder_ = recorder;
+  stream_ = stream;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::WaitPendingWaits() {
+  pending_waits_.Wait();
+}
+
+template<typename Owner>
+bool BasicReceivingFrame<Owner>::IsChunkAdded(const uint16_t chunk_index) {
+  return chunk_bitmap_[chunk_index];
+}
+
+template<typename Owner>
+bool BasicReceivingFrame<Owner>::IsTimeout() {
+  return request_timeout_;
+}
+
+// @data should be `recv_buffer_.data() + CHUNKHEADER_SIZE`
+template<typename Owner>
+void BasicReceivingFrame<Owner>::AddChunk(const ChunkHeader& header, uint8_t* data) {
+  const size_t expected_chunk_size =
+    static_cast<size_t>(header.chunk_index) + 1 == chunk_bitmap_.size() ? last_chunk_size_ : LAYOUT.PAYLOAD;
+  if (header.total_size != total_size_ || header.chunk_size != expected_chunk_size) {
+    return;
+  }
+
+  bool all_chunk_added = false;
+  bool first_chunk_added = false;
+  {
+    std::lock_guard<std::mutex> lock(chunk_bitmap_mutex_);
+    assert(header.chunk_index < chunk_bitmap_.size());
+    if (chunk_bitmap_[header.chunk_index]) {
+      return; // Duplicated
+    }
+    chunk_bitmap_[header.chunk_index] = true;
+    all_chunk_added = ++received_chunks_ == chunk_bitmap_.size();
+    first_chunk_added = received_chunks_ == 1;
+  }
+  CHUNKSTREAM_PROBE5(add_chunk, header.id, header.chunk_index, header.chunk_size,
+                     received_chunks_, header.total_chunks);
+  if (recorder_) {
+    if (first_chunk_added) {
+      recorder_->Record(FlightRecorder::FIRST_CHUNK, id_, header.chunk_index, stream_);
+    }
+    if (all_chunk_added) {
+      recorder_->Record(FlightRecorder::LAST_CHUNK, id_, header.chunk_index, stream_);
+    }
+  }
+
+  assert(data != nullptr);
+  assert(data_ != nullptr);
+
+  std::memcpy(
+    data_ + LAYOUT.ChunkOffset(header.chunk_index),
+    data,
+    header.chunk_size
+  );
+
+  // Advances the contiguous prefix once the chunk right after it is copied
+  if (header.chunk_index == contiguous_chunks_) {
+    const size_t previous_ready_size = GetReadySize();
+    {
+      std::lock_guard<std::mutex> lock(chunk_bitmap_mutex_);
+      while (contiguous_chunks_ < chunk_bitmap_.size() && chunk_bitmap_[contiguous_chunks_]) {
+        contiguous_chunks_++;
+      }
+    }
+    owner_->__FrameProgress(this, previous_ready_size);
+  }
+
+  if (all_chunk_added) {
+    status_ = READY;
+    completed_time_ = std::chrono::steady_clock::now();
+    Cancel();
+    owner_->__FrameGrabbed(this);
+  } else {
+    if (header.transmission_type == 0 && !request_resend_) { // type == INIT
+      // The timer is armed once and pushed back lazily on expiry; re-arming it on
+      // every chunk would allocate a wait operation per packet.
+      last_init_chunk_time_ = std::chrono::steady_clock::now();
+      if (!init_chunk_timer_armed_) {
+        init_chunk_timer_armed_ = true;
+        __WaitInitChunk(generation_);
+      }
+    } else { // type == RESEND
+      // nothing
+    }
+  }
+}
+
+template<typename Owner>
+int BasicReceivingFrame<Owner>::GetStatus() {
+  return status_;
+}
+
+template<typename Owner>
+uint8_t* BasicReceivingFrame<Owner>::GetData() {
+  return data_;
+}
+
+template<typename Owner>
+uint32_t BasicReceivingFrame<Owner>::GetId() const {
+  return id_;
+}
+
+template<typename Owner>
+size_t BasicReceivingFrame<Owner>::GetTotalSize() const {
+  return total_size_;
+}
+
+template<typename Owner>
+size_t BasicReceivingFrame<Owner>::GetReadySize() const {
+  return std::min(LAYOUT.ChunkOffset(contiguous_chunks_), total_size_);
+}
+
+template<typename Owner>
+std::chrono::steady_clock::time_point BasicReceivingFrame<Owner>::GetFirstChunkTime() const {
+  return first_chunk_time_;
+}
+
+template<typename Owner>
+std::chrono::steady_clock::time_point BasicReceivingFrame<Owner>::GetCompletedTime() const {
+  return completed_time_;
+}
+
+template<typename Owner>
+size_t BasicReceivingFrame<Owner>::GetResendRounds() const {
+  return resend_rounds_;
+}
+
+template<typename Owner>
+std::chrono::steady_clock::time_point BasicReceivingFrame<Owner>::GetFirstResendTime() const {
+  return first_resend_time_;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::SetDeliveredTime(const std::chrono::steady_clock::time_point time) {
+  delivered_time_ = time;
+}
+
+template<typename Owner>
+std::chrono::steady_clock::time_point BasicReceivingFrame<Owner>::GetDeliveredTime() const {
+  return delivered_time_;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::SetKernelArrival(const std::chrono::system_clock::time_point time,
+                                                  const uint64_t kernel_drops) {
+  if (!has_kernel_arrival_) {
+    first_chunk_kernel_time_ = time;
+    first_kernel_drops_ = kernel_drops;
+    has_kernel_arrival_ = true;
+  }
+  completed_kernel_time_ = time;
+  last_kernel_drops_ = kernel_drops;
+}
+
+template<typename Owner>
+std::chrono::system_clock::time_point BasicReceivingFrame<Owner>::GetFirstChunkKernelTime() const {
+  return first_chunk_kernel_time_;
+}
+
+template<typename Owner>
+std::chrono::system_clock::time_point BasicReceivingFrame<Owner>::GetCompletedKernelTime() const {
+  return completed_kernel_time_;
+}
+
+template<typename Owner>
+uint64_t BasicReceivingFrame<Owner>::GetKernelDrops() const {
+  return last_kernel_drops_ - first_kernel_drops_;
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::__WaitInitChunk(const uint32_t generation) {
+  init_chunk_timer_.expires_at(last_init_chunk_time_ + INIT_CHUNK_TIMEOUT);
+  pending_waits_.Add();
+  init_chunk_timer_.async_wait(MakeAllocatedHandler(timer_handler_memory_, [this, generation](const std::error_code& error) {
+    PendingGuard guard(pending_waits_);
+    if (error) {
+      if (
+#ifdef __linux__
+          error.value() != 125 // ECANCELED
+#elif _WIN32
+          error.value() != 995 // ERROR_OPERATION_ABORTED
+#else
+          true
+#endif
+        ) {
+          std::cerr << "INIT_CHUNK_TIMEOUT error(" << error << "): " << error.message() << std::endl;
+      }
+      return;
+    }
+    if (generation != generation_) return; // Frame was reused
+
+    // Another INIT chunk arrived while waiting
+    if (std::chrono::steady_clock::now() < last_init_chunk_time_ + INIT_CHUNK_TIMEOUT) {
+      __WaitInitChunk(generation);
+      return;
+    }
+    init_chunk_timer_armed_ = false;
+    request_resend_ = true;
+
+    // Start frame-drop timer; a deadline which comes earlier stays in effect
+    std::chrono::steady_clock::time_point drop_time = std::chrono::steady_clock::now() + FRAME_DROP_TIMEOUT;
+    if (deadline_.count() > 0) {
+      drop_time = std::min(drop_time, first_chunk_time_ + deadline_);
+    }
+    __WaitFrameDrop(generation, drop_time);
+
+    // Start resend requesting
+    __RequestResend(id_, generation); // Recursively call
+  }));
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::__WaitFrameDrop(const uint32_t generation,
+                                                 const std::chrono::steady_clock::time_point expiry) {
+  frame_drop_timer_.expires_at(expiry);
+  pending_waits_.Add();
+  frame_drop_timer_.async_wait(MakeAllocatedHandler(timer_handler_memory_, [this, generation](const std::error_code& ec) {
+    PendingGuard guard(pending_waits_);
+    if (!ec && generation == generation_ && status_ == ASSEMBLING) {
+      CHUNKSTREAM_PROBE4(frame_drop, id_, total_size_, received_chunks_, 0);
+      if (recorder_) {
+        recorder_->Record(FlightRecorder::FRAME_DROPPED, id_, 0, stream_);
+      }
+      request_resend_ = false;
+      request_timeout_ = true;
+      status_ = DROPPED;
+      owner_->__FrameDropped(id_, data_);
+    }
+  }));
+}
+
+template<typename Owner>
+void BasicReceivingFrame<Owner>::__RequestResend(const uint32_t id, const uint32_t generation) {
+  if (!request_resend_ || generation != generation_) return;
+
+  if (resend_rounds_++ == 0) {
+    first_resend_time_ = std::chrono::steady_clock::now();
+  }
+  if (recorder_) {
+    recorder_->Record(FlightRecorder::RESEND_ROUND, id, static_cast<uint16_t>(resend_rounds_), stream_);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(chunk_bitmap_mutex_);
+
+    for (size_t i = 0; i < chunk_bitmap_.size(); i++) {
+      if (!chunk_bitmap_[i]) {
+        ChunkHeader req_header;
+        req_header.id = id;
+        req_header.chunk_index = static_cast<uint16_t>(i);
+        req_header.total_chunks = static_cast<uint16_t>(chunk_bitmap_.size());
+        owner_->__RequestResend(req_header, SENDER_ENDPOINT);
+      }
+    }
+  }
+
+  resend_timer_.expires_after(RESEND_TIMEOUT);
+  pending_waits_.Add();
+  resend_timer_.async_wait(MakeAllocatedHandler(timer_handler_memory_, [this, id, generation](const std::error_code& error) {
+    PendingGuard guard(pending_waits_);
+    if (error) {
+      if (
+#ifdef __linux__
+          error.value() != 125 // ECANCELED
+#elif _WIN32
+          error.value() != 995 // ERROR_OPERATION_ABORTED
+#else
+          true
+#endif
+        ) {
+          std::cerr << "RESEND_TIMEOUT error(" << error << "): " << error.message() << std::endl;
+      }
+      return;
+    }
+    __RequestResend(id, generation);
+  }));
+}
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_RECEIVER_SIZE_CLASS_POOL_H_
+#define CHUNKSTREAM_RECEIVER_SIZE_CLASS_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chunkstream {
+
+// Pool of variable-sized blocks grouped into size classes, four per power of two,
+// so a block is at most 25% larger than requested.
+// Blocks are allocated the first time a size class is needed and recycled afterwards.
+// Free blocks of other classes are freed before a new block would take the pool over its limit,
+// so memory follows the sizes that are actually in flight instead of each class's peak.
+class SizeClassPool {
+public:
+  // @param min_block_size Smallest size class; rounded up to a power of two.
+  // @param max_block_size Largest size of a single block, or 0 for no limit.
+  // @param buffer_size Maximum number of blocks in use at the same time.
+  // @param max_total_bytes Limit of all blocks, in use or free; 0 keeps at most twice
+  //                        the most bytes that were ever in use at the same time.
+  SizeClassPool(size_t min_block_size, size_t max_block_size, size_t buffer_size,
+                size_t max_total_bytes = 0);
+
+  // @return Pointer of reserved buffer which can hold `size` bytes, or nullptr if `size` exceeds
+  //         `MAX_BLOCK_SIZE`, `BUFFER_SIZE` blocks are in use or the block would exceed `MAX_TOTAL_BYTES`.
+  uint8_t* Acquire(size_t size);
+
+  void Release(uint8_t* ptr);
+
+  // Number of blocks currently acquired
+  size_t GetUsedCount() const;
+
+  // Bytes allocated for blocks, whether in use or kept for reuse
+  size_t GetAllocatedBytes() const;
+
+private:
+  size_t __SizeClass(size_t size) const;
+  size_t __BlockSize(size_t size_class) const;
+
+  // Frees free blocks of classes other than `size_class`, largest first, until
+  // `allocated_bytes_ + size` fits in `limit`; `mutex_` must be held
+  void __Trim(size_t size_class, size_t size, size_t limit);
+
+private:
+  std::vector< std::unique_ptr<uint8_t[]> > blocks_;
+  std::vector< std::vector<uint8_t*> > free_blocks_; // Free blocks per size class
+  size_t used_count_ = 0;
+  size_t used_bytes_ = 0;
+  size_t peak_used_bytes_ = 0;
+  size_t allocated_bytes_ = 0;
+  mutable std::mutex mutex_;
+
+public:
+  const size_t BUFFER_SIZE;
+  const size_t MIN_BLOCK_SIZE;
+  const size_t MAX_BLOCK_SIZE;
+  const size_t MAX_TOTAL_BYTES;
+};
+
+}
+
+#endif
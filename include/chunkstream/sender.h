@@ -4,53 +4,696 @@
 #ifndef CHUNKSTREAM_SENDER_H_
 #define CHUNKSTREAM_SENDER_H_
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
 #include <string>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <asio.hpp>
 #include "chunkstream/core/chunk_header.h"
+#include "chunkstream/core/completion_handler.h"
+#include "chunkstream/core/packet_layout.h"
+#include "chunkstream/core/pending_count.h"
+#include "chunkstream/core/simulated_link.h"
+#include "chunkstream/core/stats.h"
+#include "chunkstream/core/trace.h"
+#include "chunkstream/sender/buffer_cursor.h"
 
 namespace chunkstream {
 
+using SendHandler = CompletionHandler<std::error_code>;
+
 struct SendingFrame {
   uint32_t id;
+  uint16_t total_chunks = 0;  // Of the frame in the slot; `headers` may be longer
   std::mutex ref_count_lock;
-  uint16_t ref_count = 0;
+  uint16_t ref_count = 0;     // Chunks being sent; the slot can be reused once it reaches 0
+  uint16_t unsent_chunks = 0; // INIT chunks not handed to the kernel yet
+  std::error_code send_error; // First error among INIT chunks
+  SendHandler sent;           // Completed once `unsent_chunks` reaches 0
   std::vector<ChunkHeader> headers;
   std::vector< std::vector<uint8_t> > chunks;
 };
 
-class Sender {
+// @tparam Layout `DynamicLayout` for a MTU given at runtime, or `StaticLayout<MTU>`
+//                to fix chunk math at compile time.
+// @tparam Socket `asio::ip::udp::socket`, or a type with the same `async_send_to()`, `send_to()`,
+//                `async_receive_from()` and `cancel()`, e.g. `SimulatedSocket`.
+template<typename Layout = DynamicLayout, typename Socket = asio::ip::udp::socket>
+class BasicSender {
+public:
+  enum Status {
+    SENT,        // Handed to the socket
+    WOULD_BLOCK, // The next slot is still being sent (`TrySend()` only)
+    STOPPED      // `Stop()` was called
+  };
+
 public:
-  Sender(const std::string& ip, const int port, const int mtu = 1500, 
-         const size_t buffer_size = 10, const size_t max_data_size = 0);
-  ~Sender();
+  // Runs on an io_context owned by the sender; `Start()` blocks the calling thread running it.
+  BasicSender(const std::string& ip, const int port, const int mtu = Layout::DEFAULT_MTU,
+              const size_t buffer_size = 10, const size_t max_data_size = 0);
+
+  // Runs on `executor` (e.g. `io_context.get_executor()` or a thread pool's executor), so that
+  // many senders can share a fixed set of I/O threads. Handlers are serialized on a strand.
+  // The executor must keep running until the sender is stopped.
+  BasicSender(const asio::any_io_executor& executor, const std::string& ip, const int port,
+              const int mtu = Layout::DEFAULT_MTU, const size_t buffer_size = 10,
+              const size_t max_data_size = 0);
+
+  // Sends through an open, bound `socket` and runs on its executor, which must not run
+  // handlers concurrently and must keep running until the sender is stopped.
+  BasicSender(std::unique_ptr<Socket> socket, const asio::ip::udp::endpoint& endpoint,
+              const int mtu = Layout::DEFAULT_MTU, const size_t buffer_size = 10,
+              const size_t max_data_size = 0);
+  ~BasicSender();
+
+  // Waits while the next slot of the circular buffer is still being sent.
+  // @return `SENT`, or `STOPPED` if `Stop()` was called before or while waiting
+  Status Send(const uint8_t* data, const size_t size);
+
+  // Sends one frame gathered from several buffers, e.g. a header, an image plane and an audio block
+  // as `std::array<asio::const_buffer, 3>`. Chunks are filled straight from the buffers.
+  template<typename ConstBufferSequence>
+  Status Send(const ConstBufferSequence& buffers);
 
-  void Send(const uint8_t* data, const size_t size);
+  // Returns `WOULD_BLOCK` instead of waiting, so that the producer can drop or coalesce the frame.
+  Status TrySend(const uint8_t* data, const size_t size);
 
-  // It will block thread
+  template<typename ConstBufferSequence>
+  Status TrySend(const ConstBufferSequence& buffers);
+
+  // Sends like `Send()` without blocking, and completes as `void(std::error_code)` on the handler's associated
+  // executor once every chunk has been handed to the kernel, e.g.
+  // `co_await sender.AsyncSend(data, size, asio::use_awaitable);`
+  // Without a free slot, the frame is copied and queued until one is released.
+  // `data` is copied when the operation is started, and needs to stay valid only until then.
+  // Completes with `asio::error::operation_aborted` if the sender is stopped.
+  template<typename CompletionToken>
+  auto AsyncSend(const uint8_t* data, const size_t size, CompletionToken&& token);
+
+  // Gathering `AsyncSend()`; the buffer sequence is copied, and the data behind it is
+  // copied when the operation is started.
+  template<typename ConstBufferSequence, typename CompletionToken>
+  auto AsyncSend(const ConstBufferSequence& buffers, CompletionToken&& token);
+
+  // Blocks the thread running the sender's own io_context,
+  // or starts receiving resend requests on the external executor and returns at once.
   void Start();
+
+  // On an external executor, it waits until all handlers of the sender have run,
+  // so it must not be called from one of the executor's threads.
   void Stop();
 
+  // Number of frames the circular buffer holds (`buffer_size`)
+  size_t GetSlotCount() const;
+
+  // Number of slots whose chunks are still being sent. A producer can lower its frame rate
+  // as this approaches `GetSlotCount()`, before `Send()` starts to block.
+  size_t GetBusySlotCount() const;
+
+  // Cheap enough to poll from a monitoring thread while sending
+  SenderStats GetStats() const;
+
+  const asio::ip::udp::endpoint& GetRemoteEndpoint() const;
+
 private:
+  // @param socket Opened here if nullptr
+  BasicSender(std::shared_ptr<asio::io_context> io_context, const asio::any_io_executor& executor,
+              std::unique_ptr<Socket>&& socket, const std::string& ip, const int port, const int mtu,
+              const size_t buffer_size, const size_t max_data_size);
+
+  template<typename ConstBufferSequence>
+  Status __Send(const ConstBufferSequence& buffers, SendHandler sent, const bool block);
+  template<typename ConstBufferSequence>
+  void __AsyncSend(const ConstBufferSequence& buffers, SendHandler sent);
+  // Takes the next slot for a frame of `header->total_size` bytes and sets `header->id`;
+  // `buffering_mutex_` must be held and the slot free
+  SendingFrame* __TakeSlot(ChunkHeader* header, SendHandler sent);
+  template<typename ConstBufferSequence>
+  void __SendChunks(SendingFrame* frame, ChunkHeader header, const ConstBufferSequence& buffers);
+  bool __IsNextSlotFree();
+  void __SlotReleased();
+  // Starts queued `AsyncSend()` calls while slots are free
+  void __StartQueuedSends();
   void __Receive();
   void __HandlePacket(ChunkHeader header);
 
-private: 
+private:
   std::atomic_bool running_ = false;
-  std::unique_ptr<asio::ip::udp::socket> socket_;
+  std::shared_ptr<asio::io_context> io_context_; // nullptr if running on an external executor
+  asio::any_io_executor executor_; // Must be ran if using async_send_to()
+  std::unique_ptr<Socket> socket_;
   asio::ip::udp::endpoint remote_endpoint_;
-  asio::io_context io_context_; // Must be ran if using async_send_to()
+  PendingCount pending_handlers_;
   asio::ip::udp::endpoint ENDPOINT;
-  const int MTU;
-  const int PAYLOAD;
+  const Layout LAYOUT;
   std::array<uint8_t, 65553> recv_buffer_;
 
-  // Circular buffer for data.
-  std::vector< std::unique_ptr<SendingFrame> > buffer_; 
-  std::atomic_int buffer_index_;
+  // Circular buffer for data. Slots are taken strictly in turn, so ids stay sorted (rotated)
+  // along the buffer for the binary search in `__HandlePacket()`.
+  std::vector< std::unique_ptr<SendingFrame> > buffer_;
+  size_t buffer_index_; // Next slot; guarded by `buffering_mutex_`
   std::mutex buffering_mutex_;
-  std::atomic<uint32_t> id_;
+  std::condition_variable slot_released_; // Notified when a slot's `ref_count` drops to 0
+  std::atomic<size_t> busy_slots_ = 0;
+  bool stopped_ = false; // Guarded by `buffering_mutex_`
+
+  // `AsyncSend()` calls waiting for a slot, with a copy of their data; guarded by `buffering_mutex_`
+  struct QueuedSend {
+    std::vector<uint8_t> data;
+    SendHandler sent;
+  };
+  std::deque<QueuedSend> queued_sends_;
+  uint32_t id_;          // Guarded by `buffering_mutex_`
+
+  StatCounter frames_sent_;
+  StatCounter packets_sent_;
+  StatCounter bytes_sent_;
+  StatCounter send_errors_;
+  StatCounter resend_requests_received_;
+  StatCounter resends_served_;
+  StatCounter resends_missed_;
+  StatCounter would_block_;
+  StatCounter blocked_sends_;
 };
 
+template<typename Layout, typename Socket>
+BasicSender<Layout, Socket>::BasicSender(const std::string& ip, const int port,
+                                         const int mtu, const size_t buffer_size, const size_t max_data_size)
+  : BasicSender(std::make_shared<asio::io_context>(), asio::any_io_executor(), nullptr,
+                ip, port, mtu, buffer_size, max_data_size) {}
+
+template<typename Layout, typename Socket>
+BasicSender<Layout, Socket>::BasicSender(const asio::any_io_executor& executor, const std::string& ip,
+                                         const int port, const int mtu, const size_t buffer_size,
+                                         const size_t max_data_size)
+  : BasicSender(nullptr, executor, nullptr, ip, port, mtu, buffer_size, max_data_size) {}
+
+template<typename Layout, typename Socket>
+BasicSender<Layout, Socket>::BasicSender(std::unique_ptr<Socket> socket, const asio::ip::udp::endpoint& endpoint,
+                                         const int mtu, const size_t buffer_size, const size_t max_data_size)
+  : BasicSender(nullptr, socket->get_executor(), std::move(socket), endpoint.address().to_string(),
+                endpoint.port(), mtu, buffer_size, max_data_size) {}
+
+template<typename Layout, typename Socket>
+BasicSender<Layout, Socket>::BasicSender(std::shared_ptr<asio::io_context> io_context,
+                                         const asio::any_io_executor& executor,
+                                         std::unique_ptr<Socket>&& socket,
+                                         const std::string& ip, const int port, const int mtu,
+                                         const size_t buffer_size, const size_t max_data_size)
+  : io_context_(std::move(io_context)),
+    executor_(io_context_ ? asio::any_io_executor(io_context_->get_executor())
+                          : asio::any_io_executor(asio::make_strand(executor))),
+    LAYOUT(mtu),
+    buffer_index_(0),
+    id_(0) {
+
+  try {
+    // Create the endpoint first to validate IP
+    ENDPOINT = asio::ip::udp::endpoint(asio::ip::address::from_string(ip), port);
+
+    // Initialize socket
+    if (socket) {
+      socket_ = std::move(socket);
+    } else {
+      if constexpr (std::is_same_v<Socket, asio::ip::udp::socket>) {
+        socket_ = std::make_unique<asio::ip::udp::socket>(
+          executor_,
+          asio::ip::udp::v4()
+        );
+        socket_->bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), 0)); // OS automatically allocates port
+      } else {
+        throw std::invalid_argument("This socket type must be opened by the caller");
+      }
+    }
+
+    // Pre-allocate buffer; without `max_data_size`, chunks are allocated on first use of a slot
+    const size_t total_chunks = max_data_size > 0 ? LAYOUT.ChunkCount(max_data_size) : 0;
+    buffer_.reserve(std::max<size_t>(buffer_size, 1));
+
+    for (size_t i = 0; i < std::max<size_t>(buffer_size, 1); i++) {
+      auto frame = std::make_unique<SendingFrame>();
+      frame->id = -1;
+
+      frame->chunks.reserve(total_chunks);
+      for (size_t j = 0; j < total_chunks; j++) {
+        frame->chunks.emplace_back(LAYOUT.PACKET_SIZE);
+      }
+      frame->headers.resize(frame->chunks.size());
+      buffer_.push_back(std::move(frame));
+    }
+
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Sender construction failed: " << e.what() << std::endl;
+    throw; // Re-throw to notify caller
+  }
+}
+
+template<typename Layout, typename Socket>
+BasicSender<Layout, Socket>::~BasicSender() {
+  Stop();
+}
+
+template<typename Layout, typename Socket>
+typename BasicSender<Layout, Socket>::Status BasicSender<Layout, Socket>::Send(const uint8_t* data, const size_t size) {
+  return __Send(asio::const_buffer(data, size), SendHandler(), true);
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence>
+typename BasicSender<Layout, Socket>::Status BasicSender<Layout, Socket>::Send(const ConstBufferSequence& buffers) {
+  return __Send(buffers, SendHandler(), true);
+}
+
+template<typename Layout, typename Socket>
+typename BasicSender<Layout, Socket>::Status BasicSender<Layout, Socket>::TrySend(const uint8_t* data, const size_t size) {
+  return __Send(asio::const_buffer(data, size), SendHandler(), false);
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence>
+typename BasicSender<Layout, Socket>::Status BasicSender<Layout, Socket>::TrySend(const ConstBufferSequence& buffers) {
+  return __Send(buffers, SendHandler(), false);
+}
+
+template<typename Layout, typename Socket>
+template<typename CompletionToken>
+auto BasicSender<Layout, Socket>::AsyncSend(const uint8_t* data, const size_t size, CompletionToken&& token) {
+  return asio::async_initiate<CompletionToken, void(std::error_code)>(
+    [this, data, size](auto handler) {
+      __AsyncSend(asio::const_buffer(data, size), SendHandler(std::move(handler)));
+    },
+    token
+  );
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence, typename CompletionToken>
+auto BasicSender<Layout, Socket>::AsyncSend(const ConstBufferSequence& buffers, CompletionToken&& token) {
+  return asio::async_initiate<CompletionToken, void(std::error_code)>(
+    [this, buffers](auto handler) {
+      __AsyncSend(buffers, SendHandler(std::move(handler)));
+    },
+    token
+  );
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence>
+typename BasicSender<Layout, Socket>::Status BasicSender<Layout, Socket>::__Send(const ConstBufferSequence& buffers,
+                                                                 SendHandler sent, const bool block) {
+  ChunkHeader header;
+  header.total_size = static_cast<uint32_t>(asio::buffer_size(buffers));
+
+  SendingFrame* frame = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(buffering_mutex_);
+    // Queued `AsyncSend()` calls go first
+    if (!stopped_ && (!queued_sends_.empty() || !__IsNextSlotFree())) {
+      if (!block) {
+        would_block_.Add();
+        return WOULD_BLOCK;
+      }
+      blocked_sends_.Add();
+      slot_released_.wait(lock, [this]() { return stopped_ || (queued_sends_.empty() && __IsNextSlotFree()); });
+    }
+    if (stopped_) {
+      lock.unlock();
+      sent(asio::error::make_error_code(asio::error::operation_aborted));
+      return STOPPED;
+    }
+    frame = __TakeSlot(&header, std::move(sent));
+  }
+  __SendChunks(frame, header, buffers);
+  return SENT;
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence>
+void BasicSender<Layout, Socket>::__AsyncSend(const ConstBufferSequence& buffers, SendHandler sent) {
+  ChunkHeader header;
+  header.total_size = static_cast<uint32_t>(asio::buffer_size(buffers));
+
+  SendingFrame* frame = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(buffering_mutex_);
+    if (stopped_) {
+      lock.unlock();
+      sent(asio::error::make_error_code(asio::error::operation_aborted));
+      return;
+    }
+    if (!queued_sends_.empty() || !__IsNextSlotFree()) {
+      // Waiting here could block the thread which has to release the slot; `__SlotReleased()` starts it instead
+      blocked_sends_.Add();
+      QueuedSend queued;
+      queued.data.resize(header.total_size);
+      asio::buffer_copy(asio::buffer(queued.data), buffers);
+      queued.sent = std::move(sent);
+      queued_sends_.push_back(std::move(queued));
+      return;
+    }
+    frame = __TakeSlot(&header, std::move(sent));
+  }
+  __SendChunks(frame, header, buffers);
+}
+
+template<typename Layout, typename Socket>
+SendingFrame* BasicSender<Layout, Socket>::__TakeSlot(ChunkHeader* header, SendHandler sent) {
+  header->total_chunks = static_cast<uint16_t>(LAYOUT.ChunkCount(header->total_size));
+  header->transmission_type = 0; // INIT
+
+  // The id is taken together with the slot, so that concurrent senders keep them in the same order
+  header->id = id_++;
+  SendingFrame* frame = buffer_[buffer_index_++ % buffer_.size()].get();
+
+  std::lock_guard<std::mutex> frame_lock(frame->ref_count_lock);
+  frame->id = header->id;
+  frame->total_chunks = header->total_chunks;
+  frame->ref_count = header->total_chunks;
+  frame->unsent_chunks = header->total_chunks;
+  frame->send_error = std::error_code();
+  frame->sent = std::move(sent);
+  if (header->total_chunks > 0) busy_slots_++;
+  return frame;
+}
+
+template<typename Layout, typename Socket>
+template<typename ConstBufferSequence>
+void BasicSender<Layout, Socket>::__SendChunks(SendingFrame* frame, ChunkHeader header,
+                                               const ConstBufferSequence& buffers) {
+  const size_t size = header.total_size;
+  BufferCursor<ConstBufferSequence> cursor(buffers);
+  frames_sent_.Add();
+
+  if (header.total_chunks == 0) {
+    frame->sent(std::error_code());
+    return;
+  }
+
+  if (frame->chunks.size() < header.total_chunks) {
+    frame->chunks.resize(
+      header.total_chunks, std::vector<uint8_t>(LAYOUT.PACKET_SIZE)
+    );
+    frame->headers.resize(frame->chunks.size());
+  }
+
+  for (size_t i = 0; i < header.total_chunks; i++) {
+    header.chunk_index = static_cast<uint16_t>(i);
+    const size_t offset = LAYOUT.ChunkOffset(i);
+    header.chunk_size = static_cast<uint32_t>(std::min(LAYOUT.PAYLOAD, size - offset));
+    frame->headers[header.chunk_index] = header;
+    uint8_t* packet = frame->chunks[header.chunk_index].data();
+    CHUNKSTREAM_PROBE5(send_chunk, header.id, header.chunk_index, header.total_chunks,
+                       header.chunk_size, header.total_size);
+
+    ChunkHeader n_header = HostToNetwork(header);
+
+    std::memcpy(packet, &n_header, CHUNKHEADER_SIZE);
+    cursor.Read(packet + CHUNKHEADER_SIZE, header.chunk_size);
+    {
+      // async
+      pending_handlers_.Add();
+      socket_->async_send_to(
+        asio::buffer(
+          packet, CHUNKHEADER_SIZE + static_cast<size_t>(header.chunk_size)
+        ),
+        ENDPOINT,
+        [this, frame](const std::error_code& error, std::size_t bytes_transferred) {
+          if (error) {
+            send_errors_.Add();
+            std::cerr << "Send error(" << error << "): " << error.message() << std::endl;
+          } else {
+            packets_sent_.Add();
+            bytes_sent_.Add(bytes_transferred);
+          }
+          SendHandler sent;
+          std::error_code send_error;
+          bool released;
+          {
+            std::lock_guard<std::mutex> lock(frame->ref_count_lock);
+            released = --frame->ref_count == 0;
+            if (error && !frame->send_error) {
+              frame->send_error = error;
+            }
+            if (--frame->unsent_chunks == 0) {
+              sent = std::move(frame->sent);
+              send_error = frame->send_error;
+            }
+          }
+          if (released) __SlotReleased();
+          sent(send_error);
+          pending_handlers_.Done();
+        }
+      );
+    }
+  }
+}
+
+template<typename Layout, typename Socket>
+bool BasicSender<Layout, Socket>::__IsNextSlotFree() {
+  // `buffering_mutex_` is held by the caller
+  SendingFrame* next = buffer_[buffer_index_ % buffer_.size()].get();
+  std::lock_guard<std::mutex> lock(next->ref_count_lock);
+  return next->ref_count == 0;
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::__SlotReleased() {
+  busy_slots_--;
+  // A waiting `Send()` checks the slot under `buffering_mutex_`; taking it here
+  // makes sure the notification is not lost between its check and its wait
+  __StartQueuedSends();
+  slot_released_.notify_all();
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::__StartQueuedSends() {
+  for (;;) {
+    QueuedSend queued;
+    ChunkHeader header;
+    SendingFrame* frame = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(buffering_mutex_);
+      if (stopped_ || queued_sends_.empty() || !__IsNextSlotFree()) {
+        return;
+      }
+      queued = std::move(queued_sends_.front());
+      queued_sends_.pop_front();
+      header.total_size = static_cast<uint32_t>(queued.data.size());
+      frame = __TakeSlot(&header, std::move(queued.sent));
+    }
+    __SendChunks(frame, header, asio::const_buffer(queued.data.data(), queued.data.size()));
+  }
+}
+
+template<typename Layout, typename Socket>
+size_t BasicSender<Layout, Socket>::GetSlotCount() const {
+  return buffer_.size();
+}
+
+template<typename Layout, typename Socket>
+size_t BasicSender<Layout, Socket>::GetBusySlotCount() const {
+  return busy_slots_;
+}
+
+template<typename Layout, typename Socket>
+const asio::ip::udp::endpoint& BasicSender<Layout, Socket>::GetRemoteEndpoint() const {
+  return ENDPOINT;
+}
+
+template<typename Layout, typename Socket>
+SenderStats BasicSender<Layout, Socket>::GetStats() const {
+  SenderStats stats;
+  stats.frames_sent = frames_sent_.Get();
+  stats.packets_sent = packets_sent_.Get();
+  stats.bytes_sent = bytes_sent_.Get();
+  stats.send_errors = send_errors_.Get();
+  stats.resend_requests_received = resend_requests_received_.Get();
+  stats.resends_served = resends_served_.Get();
+  stats.resends_missed = resends_missed_.Get();
+  stats.would_block = would_block_.Get();
+  stats.blocked_sends = blocked_sends_.Get();
+  stats.busy_slots = busy_slots_;
+  stats.slot_count = buffer_.size();
+  return stats;
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::Start() {
+  {
+    std::lock_guard<std::mutex> lock(buffering_mutex_);
+    stopped_ = false;
+  }
+  running_ = true;
+  __Receive();
+  if (io_context_) {
+    io_context_->run();
+  }
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::Stop() {
+  running_ = false;
+  std::deque<QueuedSend> queued_sends;
+  {
+    std::lock_guard<std::mutex> lock(buffering_mutex_);
+    stopped_ = true;
+    queued_sends.swap(queued_sends_);
+  }
+  slot_released_.notify_all(); // Wakes up blocked `Send()` calls
+  for (QueuedSend& queued : queued_sends) {
+    queued.sent(asio::error::make_error_code(asio::error::operation_aborted));
+  }
+  if (io_context_) {
+    io_context_->stop();
+    return;
+  }
+  // Handlers still queued on the executor refer to this sender; cancel and wait for them
+  pending_handlers_.Add();
+  asio::post(executor_, [this]() {
+    try {
+      socket_->cancel();
+    } catch (const std::exception& e) {
+      std::cerr << "Cancel error: " << e.what() << std::endl;
+    }
+    pending_handlers_.Done();
+  });
+  pending_handlers_.Wait();
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::__Receive() {
+  pending_handlers_.Add();
+  socket_->async_receive_from(
+    asio::buffer(recv_buffer_), remote_endpoint_,
+    [this](const std::error_code& error, std::size_t bytes_transferred) {
+      if (error && running_) {
+        const int& error_code = error.value();
+        if (error_code != 10054 && error_code != 10061) {
+          std::cerr << "Receive error(" << error_code << "): " << error.message() << std::endl;
+        }
+      }
+      if (!error && bytes_transferred >= CHUNKHEADER_SIZE) {
+        ChunkHeader header;
+        std::memcpy(&header, recv_buffer_.data(), CHUNKHEADER_SIZE);
+        NetworkToHost(&header);
+        try {
+          __HandlePacket(header);
+        } catch (const std::error_code& error) {
+          std::cerr << "Handling packet error(" << error << "): " << error.message() << std::endl;
+        }
+      }
+      if (running_) __Receive();
+      pending_handlers_.Done();
+    }
+  );
+}
+
+template<typename Layout, typename Socket>
+void BasicSender<Layout, Socket>::__HandlePacket(ChunkHeader header) {
+  std::unique_lock<std::mutex> lock(buffering_mutex_);
+  resend_requests_received_.Add();
+
+  SendingFrame* frame = nullptr;
+  {
+    // Binary search for rotated sorted array; O(log n)
+    // Slots not used yet keep id=-1 (the largest id) after the used ones, so the order holds.
+
+    // Searches [left, right)
+    size_t left = 0, right = buffer_.size();
+
+    while (left < right) {
+      const size_t mid = left + (right - left) / 2;
+
+      if (buffer_[mid]->id == header.id) {
+        // Stray or crafted requests beyond the frame's chunks are missed
+        SendingFrame* found = buffer_[mid].get();
+        if (header.chunk_index < found->total_chunks && header.chunk_index < found->headers.size()) {
+          frame = found;
+          std::lock_guard<std::mutex> lock(frame->ref_count_lock);
+          if (frame->ref_count++ == 0) busy_slots_++;
+        }
+        break;
+      }
+
+      // If left-side is ordered
+      if (buffer_[left]->id <= buffer_[mid]->id) {
+        if (header.id >= buffer_[left]->id && header.id < buffer_[mid]->id) {
+          right = mid;
+        } else {
+          left = mid + 1;
+        }
+      }
+      // If right-side is ordered
+      else {
+        if (header.id > buffer_[mid]->id && header.id <= buffer_[right - 1]->id) {
+          left = mid + 1;
+        } else {
+          right = mid;
+        }
+      }
+    }
+  }
+
+  if (!frame) {
+    resends_missed_.Add();
+    return;
+  }
+
+  // Change other uninitialized data
+  header.total_size = frame->headers[header.chunk_index].total_size;
+  header.chunk_size = frame->headers[header.chunk_index].chunk_size;
+
+  // Change type flag to RESEND
+  header.transmission_type = 1;
+  CHUNKSTREAM_PROBE3(resend_chunk, header.id, header.chunk_index, header.chunk_size);
+
+  ChunkHeader n_header = HostToNetwork(header);
+
+  // Overwrite chunk header (for changed type to "RESEND")
+  std::memcpy(frame->chunks[header.chunk_index].data(), &n_header, CHUNKHEADER_SIZE);
+
+  try {
+    const size_t len = socket_->send_to(
+      asio::buffer(frame->chunks[header.chunk_index].data(),
+                  CHUNKHEADER_SIZE + header.chunk_size),
+      ENDPOINT
+    );
+    resends_served_.Add();
+    packets_sent_.Add();
+    bytes_sent_.Add(len);
+  } catch (const std::error_code& error) {
+    send_errors_.Add();
+    std::cerr << "Resend error(" << error << "): " << error.message() << std::endl;
+  }
+
+  bool released;
+  {
+    std::lock_guard<std::mutex> lock(frame->ref_count_lock);
+    released = --frame->ref_count == 0;
+  }
+  if (released) {
+    lock.unlock();
+    __SlotReleased();
+  }
+}
+
+using Sender = BasicSender<DynamicLayout>;
+
+// Sends over a `SimulatedLink` instead of UDP
+using SimulatedSender = BasicSender<DynamicLayout, SimulatedSocket>;
+
+// Instantiated once in the library
+extern template class BasicSender<DynamicLayout>;
+extern template class BasicSender<Layout1500>;
+extern template class BasicSender<Layout9000>;
+extern template class BasicSender<DynamicLayout, SimulatedSocket>;
+
 }
 
-#endif
\ No newline at end of file
+#endif
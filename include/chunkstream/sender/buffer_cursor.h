@@ -0,0 +1,49 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#ifndef CHUNKSTREAM_SENDER_BUFFER_CURSOR_H_
+#define CHUNKSTREAM_SENDER_BUFFER_CURSOR_H_
+
+#include <algorithm>
+#include <asio.hpp>
+#include <cstdint>
+#include <cstring>
+
+namespace chunkstream {
+
+// Reads a const buffer sequence front to back, so a frame made of several buffers
+// can be split into chunks across buffer boundaries without coalescing it first.
+template<typename ConstBufferSequence>
+class BufferCursor {
+public:
+  explicit BufferCursor(const ConstBufferSequence& buffers)
+    : current_(asio::buffer_sequence_begin(buffers)),
+      end_(asio::buffer_sequence_end(buffers)) {}
+
+  // Copies the next `size` bytes to `dest`; stops early if the sequence ends.
+  // @return Number of bytes copied
+  size_t Read(uint8_t* dest, size_t size) {
+    size_t copied = 0;
+    while (copied < size && current_ != end_) {
+      const asio::const_buffer buffer(*current_);
+      const size_t length = std::min(buffer.size() - offset_, size - copied);
+      std::memcpy(dest + copied, static_cast<const uint8_t*>(buffer.data()) + offset_, length);
+      copied += length;
+      offset_ += length;
+      if (offset_ == buffer.size()) {
+        ++current_;
+        offset_ = 0;
+      }
+    }
+    return copied;
+  }
+
+private:
+  decltype(asio::buffer_sequence_begin(std::declval<const ConstBufferSequence&>())) current_;
+  decltype(asio::buffer_sequence_end(std::declval<const ConstBufferSequence&>())) end_;
+  size_t offset_ = 0; // Position in `*current_`
+};
+
+}
+
+#endif
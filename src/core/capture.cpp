@@ -0,0 +1,319 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/core/capture.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+
+namespace chunkstream {
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_MICROSECONDS = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NANOSECONDS = 0xa1b23c4d;
+constexpr size_t PCAP_HEADER_SIZE = 24;
+constexpr size_t PCAP_RECORD_HEADER_SIZE = 16;
+constexpr size_t PCAP_MAX_RECORD_SIZE = 262144;
+
+constexpr uint32_t LINKTYPE_ETHERNET = 1;
+constexpr uint32_t LINKTYPE_RAW = 101;
+constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+constexpr uint32_t LINKTYPE_IPV4 = 228;
+constexpr uint32_t LINKTYPE_IPV6 = 229;
+constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_IPV6 = 0x86dd;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+
+constexpr size_t IPV4_HEADER_SIZE = 20;
+constexpr size_t IPV6_HEADER_SIZE = 40;
+constexpr size_t UDP_HEADER_SIZE = 8;
+constexpr uint8_t IP_PROTOCOL_UDP = 17;
+
+constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+void Put16(uint8_t* out, const uint16_t value) {
+  out[0] = static_cast<uint8_t>(value >> 8);
+  out[1] = static_cast<uint8_t>(value);
+}
+
+uint16_t Get16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] << 8 | in[1]);
+}
+
+void Put32(uint8_t* out, const uint32_t value) {
+  // Native byte order, like the rest of the pcap header fields
+  std::memcpy(out, &value, sizeof(value));
+}
+
+std::array<uint8_t, 16> ToV6Bytes(const asio::ip::address& address) {
+  if (address.is_v6()) {
+    return address.to_v6().to_bytes();
+  }
+  return asio::ip::make_address_v6(asio::ip::v4_mapped, address.to_v4()).to_bytes();
+}
+
+}
+
+CaptureWriter::CaptureWriter(const std::string& path, const size_t snap_length)
+  : SNAP_LENGTH(snap_length > 0 ? snap_length : 65535),
+    file_buffer_(new char[WRITE_BUFFER_SIZE]) {
+  file_.rdbuf()->pubsetbuf(file_buffer_.get(), WRITE_BUFFER_SIZE);
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    std::cerr << "Capture error: Cannot open " << path << std::endl;
+    return;
+  }
+
+  uint8_t header[PCAP_HEADER_SIZE] = {};
+  Put32(header, PCAP_MAGIC_NANOSECONDS);
+  const uint16_t version_major = 2;
+  const uint16_t version_minor = 4;
+  std::memcpy(header + 4, &version_major, sizeof(version_major));
+  std::memcpy(header + 6, &version_minor, sizeof(version_minor));
+  Put32(header + 16, static_cast<uint32_t>(IPV6_HEADER_SIZE + UDP_HEADER_SIZE + SNAP_LENGTH));
+  Put32(header + 20, LINKTYPE_RAW);
+  file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  record_.reserve(PCAP_RECORD_HEADER_SIZE + IPV6_HEADER_SIZE + UDP_HEADER_SIZE + SNAP_LENGTH);
+}
+
+CaptureWriter::~CaptureWriter() {
+  Flush();
+}
+
+bool CaptureWriter::IsOpen() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return file_.is_open() && file_.good();
+}
+
+void CaptureWriter::Write(const std::chrono::system_clock::time_point arrival,
+                          const asio::ip::udp::endpoint& source,
+                          const asio::ip::udp::endpoint& destination,
+                          const uint8_t* data,
+                          const size_t size) {
+  const bool v6 = source.address().is_v6() || destination.address().is_v6();
+  const size_t ip_size = v6 ? IPV6_HEADER_SIZE : IPV4_HEADER_SIZE;
+  const size_t udp_length = std::min<size_t>(UDP_HEADER_SIZE + size, 65535);
+  const size_t kept = std::min(size, SNAP_LENGTH);
+  const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(arrival.time_since_epoch()).count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_) {
+    return;
+  }
+
+  record_.assign(PCAP_RECORD_HEADER_SIZE + ip_size + UDP_HEADER_SIZE, 0);
+  uint8_t* record = record_.data();
+  Put32(record, static_cast<uint32_t>(ns / 1000000000));
+  Put32(record + 4, static_cast<uint32_t>(ns % 1000000000));
+  Put32(record + 8, static_cast<uint32_t>(ip_size + UDP_HEADER_SIZE + kept));
+  Put32(record + 12, static_cast<uint32_t>(ip_size + udp_length));
+
+  uint8_t* ip = record + PCAP_RECORD_HEADER_SIZE;
+  if (v6) {
+    ip[0] = 0x60;
+    Put16(ip + 4, static_cast<uint16_t>(udp_length));
+    ip[6] = IP_PROTOCOL_UDP;
+    ip[7] = 64;  // Hop limit
+    const std::array<uint8_t, 16> source_bytes = ToV6Bytes(source.address());
+    const std::array<uint8_t, 16> destination_bytes = ToV6Bytes(destination.address());
+    std::memcpy(ip + 8, source_bytes.data(), source_bytes.size());
+    std::memcpy(ip + 24, destination_bytes.data(), destination_bytes.size());
+  } else {
+    ip[0] = 0x45;
+    Put16(ip + 2, static_cast<uint16_t>(std::min<size_t>(IPV4_HEADER_SIZE + udp_length, 65535)));
+    Put16(ip + 6, 0x4000);  // Don't fragment
+    ip[8] = 64;  // TTL
+    ip[9] = IP_PROTOCOL_UDP;
+    const asio::ip::address_v4::bytes_type source_bytes = source.address().to_v4().to_bytes();
+    const asio::ip::address_v4::bytes_type destination_bytes = destination.address().to_v4().to_bytes();
+    std::memcpy(ip + 12, source_bytes.data(), source_bytes.size());
+    std::memcpy(ip + 16, destination_bytes.data(), destination_bytes.size());
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < IPV4_HEADER_SIZE; i += 2) {
+      checksum += Get16(ip + i);
+    }
+    while (checksum >> 16) {
+      checksum = (checksum & 0xffff) + (checksum >> 16);
+    }
+    Put16(ip + 10, static_cast<uint16_t>(~checksum));
+  }
+
+  // The UDP checksum is left 0, i.e. not computed
+  uint8_t* udp = ip + ip_size;
+  Put16(udp, source.port());
+  Put16(udp + 2, destination.port());
+  Put16(udp + 4, static_cast<uint16_t>(udp_length));
+
+  file_.write(reinterpret_cast<const char*>(record_.data()), static_cast<std::streamsize>(record_.size()));
+  file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(kept));
+  packet_count_++;
+}
+
+void CaptureWriter::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_.is_open()) {
+    file_.flush();
+  }
+}
+
+uint64_t CaptureWriter::GetPacketCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return packet_count_;
+}
+
+CaptureReader::CaptureReader(const std::string& path)
+  : file_(path, std::ios::binary) {
+  uint8_t header[PCAP_HEADER_SIZE];
+  if (!file_ || !file_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    std::cerr << "Capture error: Cannot read " << path << std::endl;
+    return;
+  }
+
+  uint32_t magic;
+  std::memcpy(&magic, header, sizeof(magic));
+  const uint32_t swapped_magic = (magic >> 24) | ((magic >> 8) & 0xff00) | ((magic << 8) & 0xff0000) | (magic << 24);
+  if (magic == PCAP_MAGIC_MICROSECONDS || magic == PCAP_MAGIC_NANOSECONDS) {
+    swapped_ = false;
+  } else if (swapped_magic == PCAP_MAGIC_MICROSECONDS || swapped_magic == PCAP_MAGIC_NANOSECONDS) {
+    swapped_ = true;
+    magic = swapped_magic;
+  } else {
+    std::cerr << "Capture error: " << path << " is not a pcap file" << std::endl;
+    return;
+  }
+  nanoseconds_ = magic == PCAP_MAGIC_NANOSECONDS;
+
+  // The upper bits hold FCS flags
+  link_type_ = __Read32(header + 20) & 0x0fffffff;
+  if (link_type_ != LINKTYPE_ETHERNET && link_type_ != LINKTYPE_RAW && link_type_ != LINKTYPE_LINUX_SLL
+      && link_type_ != LINKTYPE_IPV4 && link_type_ != LINKTYPE_IPV6 && link_type_ != LINKTYPE_LINUX_SLL2) {
+    std::cerr << "Capture error: Unsupported link type " << link_type_ << " in " << path << std::endl;
+    return;
+  }
+  open_ = true;
+}
+
+bool CaptureReader::IsOpen() const {
+  return open_;
+}
+
+bool CaptureReader::Next(Packet* packet) {
+  if (!open_) {
+    return false;
+  }
+
+  uint8_t header[PCAP_RECORD_HEADER_SIZE];
+  while (file_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+    const uint32_t seconds = __Read32(header);
+    const uint32_t fraction = __Read32(header + 4);
+    const uint32_t included = __Read32(header + 8);
+    if (included > PCAP_MAX_RECORD_SIZE) {
+      std::cerr << "Capture error: Corrupt record of " << included << " bytes" << std::endl;
+      return false;
+    }
+
+    record_.resize(included);
+    if (!file_.read(reinterpret_cast<char*>(record_.data()), included)) {
+      // Truncated at the end, e.g. a capture still being written
+      return false;
+    }
+
+    if (!__Parse(record_.data(), record_.size(), packet)) {
+      skipped_count_++;
+      continue;
+    }
+    packet->arrival = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::seconds(seconds)
+        + (nanoseconds_ ? std::chrono::nanoseconds(fraction) : std::chrono::microseconds(fraction))));
+    return true;
+  }
+  return false;
+}
+
+uint64_t CaptureReader::GetSkippedCount() const {
+  return skipped_count_;
+}
+
+bool CaptureReader::__Parse(const uint8_t* record, const size_t size, Packet* packet) const {
+  // Strips the link layer down to the IP header
+  size_t offset = 0;
+  uint16_t ethertype = 0;
+  if (link_type_ == LINKTYPE_ETHERNET) {
+    if (size < 14) return false;
+    ethertype = Get16(record + 12);
+    offset = 14;
+    while (ethertype == ETHERTYPE_VLAN && size >= offset + 4) {
+      ethertype = Get16(record + offset + 2);
+      offset += 4;
+    }
+  } else if (link_type_ == LINKTYPE_LINUX_SLL) {
+    if (size < 16) return false;
+    ethertype = Get16(record + 14);
+    offset = 16;
+  } else if (link_type_ == LINKTYPE_LINUX_SLL2) {
+    if (size < 20) return false;
+    ethertype = Get16(record);
+    offset = 20;
+  } else {
+    if (size < 1) return false;
+    ethertype = (record[0] >> 4) == 6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4;
+  }
+
+  const uint8_t* ip = record + offset;
+  const size_t ip_available = size - offset;
+  size_t udp_offset;
+  if (ethertype == ETHERTYPE_IPV4) {
+    if (ip_available < IPV4_HEADER_SIZE || (ip[0] >> 4) != 4) return false;
+    const size_t header_size = static_cast<size_t>(ip[0] & 0x0f) * 4;
+    if (header_size < IPV4_HEADER_SIZE || ip[9] != IP_PROTOCOL_UDP) return false;
+    // More fragments, or a fragment offset
+    if ((Get16(ip + 6) & 0x3fff) != 0) return false;
+    asio::ip::address_v4::bytes_type source;
+    asio::ip::address_v4::bytes_type destination;
+    std::memcpy(source.data(), ip + 12, source.size());
+    std::memcpy(destination.data(), ip + 16, destination.size());
+    packet->source.address(asio::ip::address_v4(source));
+    packet->destination.address(asio::ip::address_v4(destination));
+    udp_offset = header_size;
+  } else if (ethertype == ETHERTYPE_IPV6) {
+    // Extension headers are not followed
+    if (ip_available < IPV6_HEADER_SIZE || (ip[0] >> 4) != 6 || ip[6] != IP_PROTOCOL_UDP) return false;
+    asio::ip::address_v6::bytes_type source;
+    asio::ip::address_v6::bytes_type destination;
+    std::memcpy(source.data(), ip + 8, source.size());
+    std::memcpy(destination.data(), ip + 24, destination.size());
+    packet->source.address(asio::ip::address_v6(source));
+    packet->destination.address(asio::ip::address_v6(destination));
+    udp_offset = IPV6_HEADER_SIZE;
+  } else {
+    return false;
+  }
+
+  if (ip_available < udp_offset + UDP_HEADER_SIZE) return false;
+  const uint8_t* udp = ip + udp_offset;
+  const size_t udp_length = Get16(udp + 4);
+  if (udp_length < UDP_HEADER_SIZE || ip_available < udp_offset + udp_length) return false;
+
+  packet->source.port(Get16(udp));
+  packet->destination.port(Get16(udp + 2));
+  packet->data.assign(udp + UDP_HEADER_SIZE, udp + udp_length);
+  return true;
+}
+
+uint32_t CaptureReader::__Read32(const uint8_t* data) const {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  if (swapped_) {
+    value = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+  }
+  return value;
+}
+
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/core/flight_recorder.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace chunkstream {
+
+namespace {
+
+const char FILE_MAGIC[4] = {'C', 'S', 'F', 'R'};
+
+size_t RoundUpPowerOfTwo(size_t size) {
+  size_t power = 1;
+  while (power < size) {
+    power <<= 1;
+  }
+  return power;
+}
+
+}
+
+FlightRecorder::FlightRecorder(const size_t capacity)
+  : CAPACITY(RoundUpPowerOfTwo(capacity > 0 ? capacity : 1)),
+    MASK(CAPACITY - 1),
+    slots_(new Slot[CAPACITY]),
+    start_tsc_(ReadTimestampCounter()),
+    start_time_(std::chrono::steady_clock::now()) {}
+
+FlightRecorder::~FlightRecorder() {
+  {
+    std::lock_guard<std::mutex> lock(spike_mutex_);
+    stopping_ = true;
+  }
+  spike_requested_.notify_one();
+  if (spike_thread_.joinable()) {
+    spike_thread_.join();
+  }
+}
+
+std::vector<FlightRecorder::Event> FlightRecorder::Snapshot() const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+
+  std::vector<Event> events;
+  events.reserve(static_cast<size_t>(head - first));
+  for (uint64_t index = first; index < head; index++) {
+    const Slot& slot = slots_[index & MASK];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index * 2 + 2) continue; // Not written yet, or overwritten since
+    const uint64_t tsc = slot.tsc.load(std::memory_order_relaxed);
+    const uint64_t payload = slot.payload.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+    Event event;
+    event.tsc = tsc;
+    event.frame_id = static_cast<uint32_t>(payload);
+    event.arg = static_cast<uint16_t>(payload >> 32);
+    event.type = static_cast<uint8_t>(payload >> 48);
+    event.stream = static_cast<uint8_t>(payload >> 56);
+    events.push_back(event);
+  }
+  return events;
+}
+
+bool FlightRecorder::Dump(const std::string& path) const {
+  const std::vector<Event> events = Snapshot();
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+  header.version = FILE_VERSION;
+  header.event_count = events.size();
+  header.dump_tsc = ReadTimestampCounter();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+  header.ticks_per_second = elapsed > 0 ? static_cast<double>(header.dump_tsc - start_tsc_) / elapsed : 0;
+  header.dump_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::cerr << "Flight recorder error: Cannot open " << path << std::endl;
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(Event));
+  return static_cast<bool>(file);
+}
+
+void FlightRecorder::DumpOnDropSpike(const std::string& path,
+                                     const size_t drops,
+                                     const std::chrono::milliseconds window) {
+  std::lock_guard<std::mutex> lock(spike_mutex_);
+  spike_path_ = path;
+  spike_window_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+  window_start_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start_time_).count();
+  window_drops_ = 0;
+  spike_drops_ = drops;
+  if (drops > 0 && !spike_thread_.joinable()) {
+    spike_thread_ = std::thread(&FlightRecorder::__DumpSpikes, this);
+  }
+}
+
+bool FlightRecorder::Load(const std::string& path, FileHeader* header, std::vector<Event>* events) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.read(reinterpret_cast<char*>(header), sizeof(FileHeader))) {
+    std::cerr << "Flight recorder error: Cannot read " << path << std::endl;
+    return false;
+  }
+  if (std::memcmp(header->magic, FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != FILE_VERSION) {
+    std::cerr << "Flight recorder error: " << path << " is not a flight recorder dump" << std::endl;
+    return false;
+  }
+  events->resize(static_cast<size_t>(header->event_count));
+  if (!file.read(reinterpret_cast<char*>(events->data()), events->size() * sizeof(Event))) {
+    std::cerr << "Flight recorder error: " << path << " is truncated" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void FlightRecorder::__CountDrop() {
+  const size_t drops = spike_drops_.load(std::memory_order_relaxed);
+  if (drops == 0) return;
+
+  // Drops racing with the start of a new window may be counted in either one
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start_time_).count();
+  int64_t window_start = window_start_ns_.load(std::memory_order_relaxed);
+  if (now - window_start > spike_window_ns_.load(std::memory_order_relaxed)
+      && window_start_ns_.compare_exchange_strong(window_start, now, std::memory_order_relaxed)) {
+    window_drops_.store(0, std::memory_order_relaxed);
+  }
+  if (window_drops_.fetch_add(1, std::memory_order_relaxed) + 1 != drops) return;
+
+  // Written off the recording thread
+  {
+    std::lock_guard<std::mutex> lock(spike_mutex_);
+    spike_requests_++;
+  }
+  spike_requested_.notify_one();
+}
+
+void FlightRecorder::__DumpSpikes() {
+  std::unique_lock<std::mutex> lock(spike_mutex_);
+  for (;;) {
+    spike_requested_.wait(lock, [this]() { return stopping_ || spike_requests_ > 0; });
+    if (stopping_) return;
+    spike_requests_ = 0;
+    const std::string path = spike_path_ + "." + std::to_string(++spike_count_);
+    lock.unlock();
+    Dump(path);
+    lock.lock();
+  }
+}
+
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/core/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace chunkstream {
+
+void Histogram::Record(const uint64_t value) {
+  buckets_[__BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+uint64_t Histogram::GetCount() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetSum() const {
+  return sum_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetMax() const {
+  return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetPercentile(const double percentile) const {
+  // Buckets are read one by one while recording goes on, so count them instead of using `count_`
+  std::array<uint64_t, BUCKET_COUNT> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) return 0;
+
+  const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+  const uint64_t rank = std::max<uint64_t>(
+    1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))));
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(__UpperBound(i), GetMax());
+    }
+  }
+  return GetMax();
+}
+
+std::vector<Histogram::Bucket> Histogram::GetBuckets() const {
+  std::vector<Bucket> buckets;
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    const uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+    if (count > 0) {
+      buckets.push_back({__UpperBound(i), count});
+    }
+  }
+  return buckets;
+}
+
+size_t Histogram::__BucketIndex(const uint64_t value) {
+  // Values below SUB_BUCKET_COUNT have a bucket each
+  if (value < SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(value);
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(value));
+#else
+  size_t msb = 63;
+  while (!(value >> msb)) {
+    msb--;
+  }
+#endif
+  const size_t shift = msb - SUB_BUCKET_BITS;
+  const size_t sub_bucket = static_cast<size_t>(value >> shift) - SUB_BUCKET_COUNT;
+  return (shift + 1) * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+uint64_t Histogram::__UpperBound(const size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  const size_t shift = index / SUB_BUCKET_COUNT - 1;
+  const uint64_t sub_bucket = index % SUB_BUCKET_COUNT;
+  const uint64_t lower = (SUB_BUCKET_COUNT + sub_bucket) << shift;
+  return lower + ((uint64_t(1) << shift) - 1);
+}
+
+}
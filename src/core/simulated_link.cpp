@@ -0,0 +1,318 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/core/simulated_link.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace chunkstream {
+
+SimulatedLink::SimulatedLink(const asio::any_io_executor& executor, const uint64_t seed)
+  : executor_(asio::make_strand(executor)),
+    timer_(executor_),
+    start_time_(std::chrono::steady_clock::now()),
+    random_(seed) {}
+
+void SimulatedLink::SetImpairments(const Impairments& impairments) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  default_path_.impairments = impairments;
+}
+
+void SimulatedLink::SetImpairments(const asio::ip::udp::endpoint& destination, const Impairments& impairments) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  paths_[destination].impairments = impairments;
+}
+
+SimulatedLink::Stats SimulatedLink::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+uint64_t SimulatedLink::Now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start_time_).count();
+}
+
+asio::any_io_executor SimulatedLink::GetExecutor() const {
+  return executor_;
+}
+
+asio::ip::udp::endpoint SimulatedLink::__Bind(SimulatedSocket* socket, const asio::ip::udp::endpoint& endpoint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  asio::ip::udp::endpoint bound = endpoint;
+  if (bound.port() == 0) {
+    for (size_t attempt = 0; attempt < 16384; ++attempt) {
+      bound.port(next_port_);
+      next_port_ = next_port_ == 65535 ? 49152 : next_port_ + 1;
+      if (sockets_.find(bound) == sockets_.end()) {
+        break;
+      }
+    }
+  }
+
+  if (!sockets_.emplace(bound, socket).second) {
+    throw std::runtime_error("Simulated endpoint " + bound.address().to_string() + ":" +
+                             std::to_string(bound.port()) + " is already bound");
+  }
+  return bound;
+}
+
+void SimulatedLink::__Unbind(const asio::ip::udp::endpoint& endpoint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sockets_.erase(endpoint);
+}
+
+void SimulatedLink::__Transmit(const asio::ip::udp::endpoint& source,
+                               const asio::ip::udp::endpoint& destination,
+                               const uint8_t* data,
+                               const size_t size) {
+  const uint64_t now = Now();
+  bool arm = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.datagrams_sent;
+
+    // Always the same number of draws, so that one datagram's fate does not shift the next one's
+    const double state_draw = __Uniform();
+    const double burst_draw = __Uniform();
+    const double loss_draw = __Uniform();
+    const double jitter_draw = __Uniform();
+    const double reorder_draw = __Uniform();
+    const double duplicate_draw = __Uniform();
+    const double duplicate_jitter_draw = __Uniform();
+
+    Path& path = __GetPath(destination);
+    const Impairments& impairments = path.impairments;
+
+    path.bad = path.bad ? state_draw >= impairments.burst_end : state_draw < impairments.burst_start;
+    if (path.bad && burst_draw < impairments.burst_loss) {
+      ++stats_.burst_lost;
+      return;
+    }
+    if (loss_draw < impairments.loss) {
+      ++stats_.lost;
+      return;
+    }
+
+    uint64_t departure = now;
+    if (impairments.bandwidth > 0) {
+      const uint64_t start = std::max(now, path.busy_until);
+      const double queued_bytes = (start - now) * 1e-9 * impairments.bandwidth / 8;
+      if (impairments.queue_size > 0 && queued_bytes + size > impairments.queue_size) {
+        ++stats_.queue_dropped;
+        return;
+      }
+      path.busy_until = start + size * 8000000000ULL / impairments.bandwidth;
+      departure = path.busy_until;
+    }
+
+    const uint64_t delay = std::chrono::duration_cast<std::chrono::nanoseconds>(impairments.delay).count();
+    const uint64_t jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(impairments.jitter).count();
+
+    Datagram datagram{departure + delay + static_cast<uint64_t>(jitter_draw * jitter),
+                      0,
+                      source,
+                      destination,
+                      std::vector<uint8_t>(data, data + size)};
+    if (reorder_draw < impairments.reorder) {
+      ++stats_.reordered;
+      datagram.due += std::chrono::duration_cast<std::chrono::nanoseconds>(impairments.reorder_delay).count();
+    }
+    if (duplicate_draw < impairments.duplicate) {
+      ++stats_.duplicated;
+      Datagram duplicate = datagram;
+      duplicate.due = departure + delay + static_cast<uint64_t>(duplicate_jitter_draw * jitter);
+      __Enqueue(std::move(duplicate));
+    }
+    __Enqueue(std::move(datagram));
+
+    if (in_flight_.top().due < earliest_due_) {
+      earliest_due_ = in_flight_.top().due;
+      arm = true;
+    }
+  }
+
+  if (arm) {
+    asio::post(executor_, [this]() { __ArmTimer(); });
+  }
+}
+
+SimulatedLink::Path& SimulatedLink::__GetPath(const asio::ip::udp::endpoint& destination) {
+  auto it = paths_.find(destination);
+  return it != paths_.end() ? it->second : default_path_;
+}
+
+SimulatedSocket* SimulatedLink::__FindSocket(const asio::ip::udp::endpoint& destination) {
+  auto it = sockets_.find(destination);
+  if (it == sockets_.end()) {
+    // A socket bound to the unspecified address receives on every address
+    const asio::ip::udp::endpoint any(destination.address().is_v6() ? asio::ip::address(asio::ip::address_v6::any())
+                                                                    : asio::ip::address(asio::ip::address_v4::any()),
+                                      destination.port());
+    it = sockets_.find(any);
+  }
+  return it != sockets_.end() ? it->second : nullptr;
+}
+
+void SimulatedLink::__Enqueue(Datagram datagram) {
+  datagram.sequence = sequence_++;
+  in_flight_.push(std::move(datagram));
+}
+
+double SimulatedLink::__Uniform() {
+  // 53 random bits, rather than std::uniform_real_distribution, whose output differs between standard libraries
+  return static_cast<double>(random_() >> 11) * 0x1.0p-53;
+}
+
+void SimulatedLink::__ArmTimer() {
+  uint64_t due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (in_flight_.empty()) {
+      return;
+    }
+    due = in_flight_.top().due;
+  }
+  if (due >= timer_due_) {
+    return;
+  }
+
+  timer_due_ = due;
+  timer_.expires_at(start_time_ + std::chrono::nanoseconds(due));
+  timer_.async_wait([this](const std::error_code& error) {
+    if (error) { // Re-armed or cancelled
+      return;
+    }
+    timer_due_ = UINT64_MAX;
+    __Deliver();
+  });
+}
+
+void SimulatedLink::__Deliver() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t now = Now();
+    while (!in_flight_.empty() && in_flight_.top().due <= now) {
+      // The top is const; it is popped right after being moved from
+      Datagram datagram = std::move(const_cast<Datagram&>(in_flight_.top()));
+      in_flight_.pop();
+
+      SimulatedSocket* socket = __FindSocket(datagram.destination);
+      if (!socket) {
+        ++stats_.unreachable;
+      } else if (!socket->__Arrive(datagram)) {
+        ++stats_.socket_overflows;
+      } else {
+        ++stats_.datagrams_delivered;
+      }
+    }
+    earliest_due_ = in_flight_.empty() ? UINT64_MAX : in_flight_.top().due;
+  }
+  __ArmTimer();
+}
+
+SimulatedSocket::SimulatedSocket(SimulatedLink& link,
+                                 const asio::ip::udp::endpoint& local_endpoint,
+                                 const size_t receive_queue_size)
+  : RECEIVE_QUEUE_SIZE(receive_queue_size),
+    link_(link),
+    local_endpoint_(link.__Bind(this, local_endpoint)) {}
+
+SimulatedSocket::~SimulatedSocket() {
+  link_.__Unbind(local_endpoint_);
+}
+
+SimulatedSocket::executor_type SimulatedSocket::get_executor() const {
+  return link_.executor_;
+}
+
+asio::ip::udp::endpoint SimulatedSocket::local_endpoint() const {
+  return local_endpoint_;
+}
+
+void SimulatedSocket::async_receive_from(const asio::mutable_buffer& buffer,
+                                         asio::ip::udp::endpoint& sender_endpoint,
+                                         ReceiveHandler handler) {
+  std::lock_guard<std::mutex> lock(link_.mutex_);
+
+  if (pending_) {
+    std::cerr << "SimulatedSocket supports one pending receive at a time" << std::endl;
+    asio::post(link_.executor_, [handler = std::move(handler)]() {
+      handler(asio::error::make_error_code(asio::error::in_progress), 0);
+    });
+    return;
+  }
+
+  if (received_.empty()) {
+    pending_ = std::move(handler);
+    pending_buffer_ = buffer;
+    pending_endpoint_ = &sender_endpoint;
+    return;
+  }
+
+  SimulatedLink::Datagram& datagram = received_.front();
+  const size_t size = std::min(buffer.size(), datagram.data.size());
+  std::memcpy(buffer.data(), datagram.data.data(), size);
+  sender_endpoint = datagram.source;
+  received_.pop_front();
+  asio::post(link_.executor_, [handler = std::move(handler), size]() {
+    handler(std::error_code(), size);
+  });
+}
+
+void SimulatedSocket::async_send_to(const asio::const_buffer& buffer,
+                                    const asio::ip::udp::endpoint& destination,
+                                    SendHandler handler) {
+  const size_t size = send_to(buffer, destination);
+  asio::post(link_.executor_, [handler = std::move(handler), size]() {
+    handler(std::error_code(), size);
+  });
+}
+
+std::size_t SimulatedSocket::send_to(const asio::const_buffer& buffer, const asio::ip::udp::endpoint& destination) {
+  link_.__Transmit(local_endpoint_, destination, static_cast<const uint8_t*>(buffer.data()), buffer.size());
+  return buffer.size();
+}
+
+void SimulatedSocket::cancel() {
+  ReceiveHandler handler;
+  {
+    std::lock_guard<std::mutex> lock(link_.mutex_);
+    handler = std::move(pending_);
+    pending_ = nullptr;
+    pending_endpoint_ = nullptr;
+  }
+  if (handler) {
+    asio::post(link_.executor_, [handler = std::move(handler)]() {
+      handler(asio::error::make_error_code(asio::error::operation_aborted), 0);
+    });
+  }
+}
+
+bool SimulatedSocket::__Arrive(SimulatedLink::Datagram& datagram) {
+  if (pending_) {
+    const size_t size = std::min(pending_buffer_.size(), datagram.data.size());
+    std::memcpy(pending_buffer_.data(), datagram.data.data(), size);
+    *pending_endpoint_ = datagram.source;
+    pending_endpoint_ = nullptr;
+    asio::post(link_.executor_, [handler = std::move(pending_), size]() {
+      handler(std::error_code(), size);
+    });
+    pending_ = nullptr;
+    return true;
+  }
+
+  if (received_.size() >= RECEIVE_QUEUE_SIZE) {
+    return false;
+  }
+  received_.push_back(std::move(datagram));
+  return true;
+}
+
+}
@@ -60,7 +60,7 @@ std::unordered_map<uint32_t, ReceivedFrameInfo> received_frames;
 std::mutex verification_mutex;
 
 // Sender statistics
-struct SenderStats {
+struct SenderTestStats {
     std::atomic<size_t> frames_sent{0};
     std::atomic<size_t> bytes_sent{0};
     std::atomic<double> average_fps{0};
@@ -69,7 +69,7 @@ struct SenderStats {
 };
 
 // Receiver statistics
-struct ReceiverStats {
+struct ReceiverTestStats {
     std::atomic<size_t> frames_received{0};
     std::atomic<size_t> bytes_received{0};
     std::atomic<size_t> frames_dropped{0};
@@ -83,8 +83,8 @@ struct ReceiverStats {
 };
 
 // Global statistics
-SenderStats sender_stats;
-ReceiverStats receiver_stats;
+SenderTestStats sender_stats;
+ReceiverTestStats receiver_stats;
 std::atomic<bool> test_running{true};
 std::atomic<uint32_t> global_frame_id{0};
 
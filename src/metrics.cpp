@@ -0,0 +1,381 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/metrics.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace chunkstream {
+
+namespace {
+
+struct ReceiverCounter {
+  const char* name;
+  const char* help;
+  uint64_t ReceiverStats::*field;
+};
+
+struct ReceiverGauge {
+  const char* name;
+  const char* help;
+  size_t ReceiverStats::*field;
+};
+
+struct SenderCounter {
+  const char* name;
+  const char* help;
+  uint64_t SenderStats::*field;
+};
+
+struct SenderGauge {
+  const char* name;
+  const char* help;
+  size_t SenderStats::*field;
+};
+
+struct HistogramFamily {
+  const char* name;
+  const char* help;
+  const char* unit;   // Empty for plain counts
+  double scale;       // Recorded value to exported value
+  const double* bounds;
+  size_t bound_count;
+};
+
+const ReceiverCounter RECEIVER_COUNTERS[] = {
+  {"chunkstream_receiver_packets_received", "Datagrams received", &ReceiverStats::packets_received},
+  {"chunkstream_receiver_bytes_received", "Bytes received, including chunk headers", &ReceiverStats::bytes_received},
+  {"chunkstream_receiver_malformed_packets", "Datagrams with an invalid chunk header", &ReceiverStats::malformed_packets},
+  {"chunkstream_receiver_duplicate_chunks", "Chunks already added to their frame", &ReceiverStats::duplicate_chunks},
+  {"chunkstream_receiver_late_chunks", "Chunks of frames no longer assembling", &ReceiverStats::late_chunks},
+  {"chunkstream_receiver_no_buffer_chunks", "Chunks of new frames dropped without a free frame or data block", &ReceiverStats::no_buffer_chunks},
+  {"chunkstream_receiver_no_packet_buffer", "Receives not started without a free packet buffer", &ReceiverStats::no_packet_buffer},
+  {"chunkstream_receiver_kernel_drops", "Datagrams the kernel dropped with the socket buffer full", &ReceiverStats::kernel_drops},
+  {"chunkstream_receiver_resend_requests_sent", "Resend requests sent", &ReceiverStats::resend_requests_sent},
+  {"chunkstream_receiver_bytes_sent", "Bytes of resend requests sent", &ReceiverStats::bytes_sent},
+  {"chunkstream_receiver_frames_completed", "Frames assembled", &ReceiverStats::frames_completed},
+  {"chunkstream_receiver_frames_timed_out", "Frames dropped by the drop timeout or deadline", &ReceiverStats::frames_timed_out},
+  {"chunkstream_receiver_frames_abandoned", "Frames dropped by latest-only or ordered delivery", &ReceiverStats::frames_abandoned},
+};
+
+const ReceiverGauge RECEIVER_GAUGES[] = {
+  {"chunkstream_receiver_frames_in_use", "Frames assembling or not released yet", &ReceiverStats::frames_in_use},
+  {"chunkstream_receiver_frame_slots", "Frames the receiver can hold", &ReceiverStats::frame_slots},
+  {"chunkstream_receiver_data_blocks_in_use", "Frame data blocks in use", &ReceiverStats::data_blocks_in_use},
+  {"chunkstream_receiver_data_block_bytes", "Bytes allocated for frame data blocks", &ReceiverStats::data_block_bytes},
+};
+
+const SenderCounter SENDER_COUNTERS[] = {
+  {"chunkstream_sender_frames_sent", "Frames sent", &SenderStats::frames_sent},
+  {"chunkstream_sender_packets_sent", "Chunks handed to the kernel, including resends", &SenderStats::packets_sent},
+  {"chunkstream_sender_bytes_sent", "Bytes sent, including chunk headers", &SenderStats::bytes_sent},
+  {"chunkstream_sender_send_errors", "Chunks which failed to send", &SenderStats::send_errors},
+  {"chunkstream_sender_resend_requests_received", "Resend requests received", &SenderStats::resend_requests_received},
+  {"chunkstream_sender_resends_served", "Chunks resent", &SenderStats::resends_served},
+  {"chunkstream_sender_resends_missed", "Resend requests for frames no longer buffered", &SenderStats::resends_missed},
+  {"chunkstream_sender_would_block", "TrySend calls refused for lack of a free slot", &SenderStats::would_block},
+  {"chunkstream_sender_blocked_sends", "Send calls which waited for a free slot", &SenderStats::blocked_sends},
+};
+
+const SenderGauge SENDER_GAUGES[] = {
+  {"chunkstream_sender_busy_slots", "Slots whose chunks are still being sent", &SenderStats::busy_slots},
+  {"chunkstream_sender_slot_count", "Slots of the circular buffer", &SenderStats::slot_count},
+};
+
+const double TIME_BOUNDS[] = {
+  0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+  0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+};
+
+const double ROUND_BOUNDS[] = {0, 1, 2, 3, 4, 5, 10, 20};
+
+// In the order of `ReceiverSource::histograms`
+const HistogramFamily RECEIVER_HISTOGRAMS[] = {
+  {"chunkstream_receiver_assembly_seconds", "Time from the first to the last chunk of a frame",
+   "seconds", 1e-9, TIME_BOUNDS, std::size(TIME_BOUNDS)},
+  {"chunkstream_receiver_resend_recovery_seconds", "Time from the first resend request to completion",
+   "seconds", 1e-9, TIME_BOUNDS, std::size(TIME_BOUNDS)},
+  {"chunkstream_receiver_resend_rounds", "Resend rounds per completed frame",
+   "", 1, ROUND_BOUNDS, std::size(ROUND_BOUNDS)},
+  {"chunkstream_receiver_hold_seconds", "Time from handing a frame to the handler until its release",
+   "seconds", 1e-9, TIME_BOUNDS, std::size(TIME_BOUNDS)},
+  {"chunkstream_receiver_socket_queue_seconds", "Time datagrams waited in the socket buffer",
+   "seconds", 1e-9, TIME_BOUNDS, std::size(TIME_BOUNDS)},
+};
+
+const size_t MAX_REQUEST_SIZE = 8192;
+
+void WriteFamily(std::ostream& out, const char* name, const char* type, const char* help) {
+  out << "# TYPE " << name << " " << type << "\n"
+      << "# HELP " << name << " " << help << "\n";
+}
+
+void WriteHistogram(std::ostream& out, const HistogramFamily& family,
+                    const std::string& labels, const Histogram& histogram) {
+  // Histogram buckets are finer than the exported ones; each is counted under the first bound above it
+  const std::vector<Histogram::Bucket> buckets = histogram.GetBuckets();
+  uint64_t cumulative = 0;
+  size_t next = 0;
+  for (size_t i = 0; i < family.bound_count; i++) {
+    while (next < buckets.size() && static_cast<double>(buckets[next].upper_bound) * family.scale <= family.bounds[i]) {
+      cumulative += buckets[next].count;
+      next++;
+    }
+    out << family.name << "_bucket{" << labels << ",le=\"" << family.bounds[i] << "\"} " << cumulative << "\n";
+  }
+  for (; next < buckets.size(); next++) {
+    cumulative += buckets[next].count;
+  }
+  out << family.name << "_bucket{" << labels << ",le=\"+Inf\"} " << cumulative << "\n"
+      << family.name << "_count{" << labels << "} " << cumulative << "\n"
+      << family.name << "_sum{" << labels << "} "
+      << static_cast<double>(histogram.GetSum()) * family.scale << "\n";
+}
+
+}
+
+// Reads one request and answers it with the current metrics
+class MetricsExporter::HttpSession : public std::enable_shared_from_this<HttpSession> {
+public:
+  HttpSession(asio::ip::tcp::socket socket, const MetricsExporter* exporter)
+    : socket_(std::move(socket)), request_(MAX_REQUEST_SIZE), exporter_(exporter) {}
+
+  void Start() {
+    std::shared_ptr<HttpSession> self = shared_from_this();
+    asio::async_read_until(socket_, request_, "\r\n\r\n",
+      [self](const std::error_code& error, std::size_t) {
+        if (error) return;
+        self->__Respond();
+      }
+    );
+  }
+
+private:
+  void __Respond() {
+    std::istream request(&request_);
+    std::string method, target;
+    request >> method >> target;
+
+    std::string status = "200 OK";
+    std::string content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    std::string body;
+    if (method != "GET") {
+      status = "405 Method Not Allowed";
+      content_type = "text/plain";
+    } else if (target != "/metrics" && target != "/") {
+      status = "404 Not Found";
+      content_type = "text/plain";
+    } else {
+      body = exporter_->Render();
+    }
+
+    response_ = "HTTP/1.1 " + status + "\r\n"
+                "Content-Type: " + content_type + "\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "Connection: close\r\n\r\n" + body;
+
+    std::shared_ptr<HttpSession> self = shared_from_this();
+    asio::async_write(socket_, asio::buffer(response_),
+      [self](const std::error_code&, std::size_t) {
+        // Fails if the client already closed the connection
+        asio::error_code ignored;
+        self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+      }
+    );
+  }
+
+private:
+  asio::ip::tcp::socket socket_;
+  asio::streambuf request_;
+  std::string response_;
+  const MetricsExporter* exporter_;
+};
+
+MetricsExporter::~MetricsExporter() {
+  Stop();
+}
+
+void MetricsExporter::Remove(const void* source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  receivers_.erase(std::remove_if(receivers_.begin(), receivers_.end(),
+    [source](const ReceiverSource& receiver) { return receiver.source == source; }), receivers_.end());
+  senders_.erase(std::remove_if(senders_.begin(), senders_.end(),
+    [source](const SenderSource& sender) { return sender.source == source; }), senders_.end());
+}
+
+std::string MetricsExporter::Render() const {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  std::ostringstream out;
+  out << std::setprecision(12);
+
+  // Samples of one family must be adjacent, so each family goes over every stream
+  if (!receivers_.empty()) {
+    std::vector<ReceiverStats> stats;
+    stats.reserve(receivers_.size());
+    for (const ReceiverSource& receiver : receivers_) {
+      stats.push_back(receiver.stats());
+    }
+    for (const ReceiverCounter& counter : RECEIVER_COUNTERS) {
+      WriteFamily(out, counter.name, "counter", counter.help);
+      for (size_t i = 0; i < receivers_.size(); i++) {
+        out << counter.name << "_total{" << receivers_[i].labels << "} " << stats[i].*counter.field << "\n";
+      }
+    }
+    for (const ReceiverGauge& gauge : RECEIVER_GAUGES) {
+      WriteFamily(out, gauge.name, "gauge", gauge.help);
+      for (size_t i = 0; i < receivers_.size(); i++) {
+        out << gauge.name << "{" << receivers_[i].labels << "} " << stats[i].*gauge.field << "\n";
+      }
+    }
+    for (size_t h = 0; h < std::size(RECEIVER_HISTOGRAMS); h++) {
+      const HistogramFamily& family = RECEIVER_HISTOGRAMS[h];
+      WriteFamily(out, family.name, "histogram", family.help);
+      if (family.unit[0] != '\0') {
+        out << "# UNIT " << family.name << " " << family.unit << "\n";
+      }
+      for (const ReceiverSource& receiver : receivers_) {
+        WriteHistogram(out, family, receiver.labels, *receiver.histograms[h]);
+      }
+    }
+  }
+
+  if (!senders_.empty()) {
+    std::vector<SenderStats> stats;
+    stats.reserve(senders_.size());
+    for (const SenderSource& sender : senders_) {
+      stats.push_back(sender.stats());
+    }
+    for (const SenderCounter& counter : SENDER_COUNTERS) {
+      WriteFamily(out, counter.name, "counter", counter.help);
+      for (size_t i = 0; i < senders_.size(); i++) {
+        out << counter.name << "_total{" << senders_[i].labels << "} " << stats[i].*counter.field << "\n";
+      }
+    }
+    for (const SenderGauge& gauge : SENDER_GAUGES) {
+      WriteFamily(out, gauge.name, "gauge", gauge.help);
+      for (size_t i = 0; i < senders_.size(); i++) {
+        out << gauge.name << "{" << senders_[i].labels << "} " << stats[i].*gauge.field << "\n";
+      }
+    }
+  }
+
+  out << "# EOF\n";
+  return out.str();
+}
+
+bool MetricsExporter::ServeHttp(const unsigned short port) {
+  if (acceptor_) {
+    std::cerr << "Metrics error: Already serving" << std::endl;
+    return false;
+  }
+  try {
+    acceptor_ = std::make_unique<asio::ip::tcp::acceptor>(
+      io_context_,
+      asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port)
+    );
+  } catch (const std::exception& e) {
+    std::cerr << "Metrics error: " << e.what() << std::endl;
+    acceptor_.reset();
+    return false;
+  }
+  __Accept();
+  http_thread_ = std::thread([this]() { io_context_.run(); });
+  return true;
+}
+
+void MetricsExporter::DumpToFile(const std::string& path, const std::chrono::milliseconds interval) {
+  if (dump_thread_.joinable()) {
+    std::cerr << "Metrics error: Already dumping" << std::endl;
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    stopped_ = false;
+  }
+  dump_thread_ = std::thread(&MetricsExporter::__Dump, this, path, interval);
+}
+
+void MetricsExporter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    stopped_ = true;
+  }
+  dump_stopped_.notify_all();
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+
+  io_context_.stop();
+  if (http_thread_.joinable()) {
+    http_thread_.join();
+  }
+  acceptor_.reset();
+  io_context_.restart();
+}
+
+void MetricsExporter::__AddReceiver(ReceiverSource source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  receivers_.push_back(std::move(source));
+}
+
+void MetricsExporter::__AddSender(SenderSource source) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  senders_.push_back(std::move(source));
+}
+
+void MetricsExporter::__Accept() {
+  acceptor_->async_accept(
+    [this](const std::error_code& error, asio::ip::tcp::socket socket) {
+      if (error) {
+        if (acceptor_->is_open()) {
+          std::cerr << "Metrics accept error(" << error << "): " << error.message() << std::endl;
+        }
+        return;
+      }
+      std::make_shared<HttpSession>(std::move(socket), this)->Start();
+      __Accept();
+    }
+  );
+}
+
+void MetricsExporter::__Dump(const std::string& path, const std::chrono::milliseconds interval) {
+  const std::string temporary_path = path + ".tmp";
+  std::unique_lock<std::mutex> lock(dump_mutex_);
+  while (!stopped_) {
+    lock.unlock();
+    {
+      std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+      file << Render();
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+      std::cerr << "Metrics dump error(" << error << "): " << error.message() << std::endl;
+    }
+    lock.lock();
+    dump_stopped_.wait_for(lock, interval, [this]() { return stopped_; });
+  }
+}
+
+std::string MetricsExporter::__Labels(const unsigned short port, const std::string& peer) {
+  std::string escaped;
+  for (const char c : peer) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return "port=\"" + std::to_string(port) + "\",peer=\"" + escaped + "\"";
+}
+
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/receiver/dispatcher.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace chunkstream {
+
+namespace {
+
+// How long an idle worker sleeps before checking whether it was stopped
+const std::chrono::milliseconds IDLE_TIMEOUT(100);
+
+}
+
+Dispatcher::Dispatcher(Handler handler,
+                       const size_t worker_count,
+                       const size_t queue_capacity,
+                       const FrameQueue::OverflowPolicy policy)
+  : WORKER_COUNT(worker_count > 0 ? worker_count : 1),
+    handler_(std::move(handler)) {
+  workers_.reserve(WORKER_COUNT);
+  for (size_t i = 0; i < WORKER_COUNT; i++) {
+    workers_.push_back(std::make_unique<Worker>(queue_capacity, policy));
+  }
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread = std::thread(&Dispatcher::__Run, this, worker.get());
+  }
+}
+
+Dispatcher::~Dispatcher() {
+  Stop();
+}
+
+void Dispatcher::operator()(FrameView frame) {
+  workers_[__WorkerIndex(frame.GetSource())]->queue(std::move(frame));
+}
+
+void Dispatcher::Stop() {
+  running_ = false;
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->queue.Close();
+  }
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+    worker->queue.Clear();
+  }
+}
+
+void Dispatcher::Clear(const void* source) {
+  Worker* worker = workers_[__WorkerIndex(source)].get();
+  worker->queue.Clear(source);
+  std::unique_lock<std::mutex> lock(worker->mutex);
+  worker->frame_done.wait(lock, [worker, source] { return worker->active_source != source; });
+}
+
+size_t Dispatcher::GetWorkerCount() const {
+  return WORKER_COUNT;
+}
+
+const FrameQueue& Dispatcher::GetQueue(const size_t worker) const {
+  return workers_.at(worker)->queue;
+}
+
+Dispatcher::QueueWait Dispatcher::GetQueueWait() const {
+  QueueWait wait;
+  wait.count = wait_count_;
+  wait.total = std::chrono::nanoseconds(wait_total_ns_);
+  wait.max = std::chrono::nanoseconds(wait_max_ns_);
+  return wait;
+}
+
+void Dispatcher::__Run(Worker* worker) {
+  while (running_) {
+    // The source is marked busy as the frame leaves the queue, so that `Clear()` waits for it
+    FrameView frame = worker->queue.Receive(IDLE_TIMEOUT, worker->mutex, worker->active_source);
+    if (!frame) continue;
+
+    const int64_t wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      FrameView::Clock::now() - frame.GetCompletedTime()).count();
+    wait_count_++;
+    wait_total_ns_ += wait_ns;
+    int64_t max_ns = wait_max_ns_;
+    while (wait_ns > max_ns && !wait_max_ns_.compare_exchange_weak(max_ns, wait_ns)) {}
+
+    try {
+      handler_(std::move(frame));
+    } catch (const std::exception& e) {
+      std::cerr << "Dispatcher handler error: " << e.what() << std::endl;
+    }
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      worker->active_source = nullptr;
+    }
+    worker->frame_done.notify_all();
+  }
+}
+
+size_t Dispatcher::__WorkerIndex(const void* source) const {
+  // Receivers are allocated at aligned addresses; mix the bits before taking the modulo
+  const uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(source));
+  return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) % WORKER_COUNT;
+}
+
+}
@@ -0,0 +1,203 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/receiver/frame_queue.h"
+
+#include <utility>
+
+namespace chunkstream {
+
+namespace {
+
+std::error_code OperationAborted() {
+  return asio::error::make_error_code(asio::error::operation_aborted);
+}
+
+}
+
+FrameQueue::FrameQueue(const size_t capacity, const OverflowPolicy policy)
+  : CAPACITY(capacity > 0 ? capacity : 1), POLICY(policy) {
+  ring_.resize(CAPACITY);
+}
+
+FrameQueue::~FrameQueue() {
+  Close();
+}
+
+void FrameQueue::operator()(FrameView frame) {
+  push_count_++;
+  // Views are released outside of the lock, since releasing calls back into the receiver
+  FrameView evicted;
+  ReceiveHandler waiter;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!closed_ && !waiters_.empty()) {
+      waiter = std::move(waiters_.front());
+      waiters_.pop_front();
+    } else if (!closed_ && size_ == CAPACITY) {
+      if (POLICY == DROP_OLDEST) {
+        evicted = __Pop();
+        drop_oldest_count_++;
+      } else if (POLICY == BLOCK) {
+        block_count_++;
+        not_full_.wait(lock, [this] { return closed_ || size_ < CAPACITY; });
+      }
+    }
+    if (waiter) {
+      // Handed to the waiting consumer below
+    } else if (closed_ || size_ == CAPACITY) {
+      drop_newest_count_++;
+      evicted = std::move(frame);
+    } else {
+      ring_[(head_ + size_) % CAPACITY] = std::move(frame);
+      size_++;
+    }
+  }
+  if (waiter) {
+    waiter(std::error_code(), std::move(frame));
+    return;
+  }
+  not_empty_.notify_one();
+}
+
+FrameView FrameQueue::TryReceive() {
+  FrameView frame;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ == 0) {
+      return frame;
+    }
+    frame = __Pop();
+  }
+  not_full_.notify_one();
+  return frame;
+}
+
+FrameView FrameQueue::Receive(const std::chrono::milliseconds timeout) {
+  FrameView frame;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!not_empty_.wait_for(lock, timeout, [this] { return closed_ || size_ > 0; }) || size_ == 0) {
+      return frame;
+    }
+    frame = __Pop();
+  }
+  not_full_.notify_one();
+  return frame;
+}
+
+FrameView FrameQueue::Receive(const std::chrono::milliseconds timeout,
+                              std::mutex& source_mutex, const void*& popped_source) {
+  FrameView frame;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!not_empty_.wait_for(lock, timeout, [this] { return closed_ || size_ > 0; }) || size_ == 0) {
+      return frame;
+    }
+    frame = __Pop();
+    std::lock_guard<std::mutex> source_lock(source_mutex);
+    popped_source = frame.GetSource();
+  }
+  not_full_.notify_one();
+  return frame;
+}
+
+void FrameQueue::Close() {
+  std::deque<ReceiveHandler> waiters;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    waiters.swap(waiters_);
+  }
+  not_empty_.notify_all();
+  not_full_.notify_all();
+  for (ReceiveHandler& waiter : waiters) {
+    waiter(OperationAborted(), FrameView());
+  }
+}
+
+void FrameQueue::Open() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = false;
+}
+
+void FrameQueue::Clear() {
+  std::vector<FrameView> frames;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames.reserve(size_);
+    while (size_ > 0) {
+      frames.push_back(__Pop());
+    }
+  }
+  not_full_.notify_all();
+}
+
+void FrameQueue::Clear(const void* source) {
+  std::vector<FrameView> frames;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Compacts the other receivers' frames to the front, keeping their order
+    const size_t size = size_;
+    size_t kept = 0;
+    for (size_t i = 0; i < size; i++) {
+      FrameView& frame = ring_[(head_ + i) % CAPACITY];
+      if (frame.GetSource() == source) {
+        frames.push_back(std::move(frame));
+      } else {
+        ring_[(head_ + kept++) % CAPACITY] = std::move(frame);
+      }
+    }
+    size_ = kept;
+  }
+  not_full_.notify_all();
+}
+
+size_t FrameQueue::GetSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+size_t FrameQueue::GetPushCount() const {
+  return push_count_;
+}
+
+size_t FrameQueue::GetDropOldestCount() const {
+  return drop_oldest_count_;
+}
+
+size_t FrameQueue::GetDropNewestCount() const {
+  return drop_newest_count_;
+}
+
+size_t FrameQueue::GetBlockCount() const {
+  return block_count_;
+}
+
+void FrameQueue::__AsyncReceive(ReceiveHandler handler) {
+  FrameView frame;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ > 0) {
+      frame = __Pop();
+    } else if (!closed_) {
+      waiters_.push_back(std::move(handler));
+      return;
+    }
+  }
+  not_full_.notify_one();
+  if (frame) {
+    handler(std::error_code(), std::move(frame));
+  } else {
+    handler(OperationAborted(), FrameView());
+  }
+}
+
+FrameView FrameQueue::__Pop() {
+  FrameView frame = std::move(ring_[head_]);
+  head_ = (head_ + 1) % CAPACITY;
+  size_--;
+  return frame;
+}
+
+}
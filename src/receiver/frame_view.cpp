@@ -0,0 +1,114 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/receiver/frame_view.h"
+
+#include <utility>
+
+namespace chunkstream {
+
+FrameView::FrameView(void* owner,
+                     ReleaseFunction release,
+                     const uint32_t id,
+                     const uint8_t* data,
+                     const size_t size,
+                     const Clock::time_point first_chunk_time,
+                     const Clock::time_point completed_time,
+                     const KernelClock::time_point first_chunk_kernel_time,
+                     const KernelClock::time_point completed_kernel_time,
+                     const uint64_t kernel_drops)
+  : owner_(owner),
+    release_(release),
+    id_(id),
+    data_(data),
+    size_(size),
+    first_chunk_time_(first_chunk_time),
+    completed_time_(completed_time),
+    first_chunk_kernel_time_(first_chunk_kernel_time),
+    completed_kernel_time_(completed_kernel_time),
+    kernel_drops_(kernel_drops) {}
+
+FrameView::FrameView(FrameView&& other) noexcept
+  : owner_(std::exchange(other.owner_, nullptr)),
+    release_(std::exchange(other.release_, nullptr)),
+    id_(other.id_),
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    first_chunk_time_(other.first_chunk_time_),
+    completed_time_(other.completed_time_),
+    first_chunk_kernel_time_(other.first_chunk_kernel_time_),
+    completed_kernel_time_(other.completed_kernel_time_),
+    kernel_drops_(other.kernel_drops_) {}
+
+FrameView& FrameView::operator=(FrameView&& other) noexcept {
+  if (this != &other) {
+    Release();
+    owner_ = std::exchange(other.owner_, nullptr);
+    release_ = std::exchange(other.release_, nullptr);
+    id_ = other.id_;
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    first_chunk_time_ = other.first_chunk_time_;
+    completed_time_ = other.completed_time_;
+    first_chunk_kernel_time_ = other.first_chunk_kernel_time_;
+    completed_kernel_time_ = other.completed_kernel_time_;
+    kernel_drops_ = other.kernel_drops_;
+  }
+  return *this;
+}
+
+FrameView::~FrameView() {
+  Release();
+}
+
+void FrameView::Release() {
+  if (release_) {
+    release_(owner_, id_);
+  }
+  owner_ = nullptr;
+  release_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+const uint8_t* FrameView::GetData() const {
+  return data_;
+}
+
+size_t FrameView::GetSize() const {
+  return size_;
+}
+
+uint32_t FrameView::GetId() const {
+  return id_;
+}
+
+const void* FrameView::GetSource() const {
+  return owner_;
+}
+
+FrameView::Clock::time_point FrameView::GetFirstChunkTime() const {
+  return first_chunk_time_;
+}
+
+FrameView::Clock::time_point FrameView::GetCompletedTime() const {
+  return completed_time_;
+}
+
+FrameView::KernelClock::time_point FrameView::GetFirstChunkKernelTime() const {
+  return first_chunk_kernel_time_;
+}
+
+FrameView::KernelClock::time_point FrameView::GetCompletedKernelTime() const {
+  return completed_kernel_time_;
+}
+
+uint64_t FrameView::GetKernelDrops() const {
+  return kernel_drops_;
+}
+
+FrameView::operator bool() const {
+  return release_ != nullptr;
+}
+
+}
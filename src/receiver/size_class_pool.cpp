@@ -0,0 +1,165 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+#include "chunkstream/receiver/size_class_pool.h"
+
+#include <algorithm>
+
+namespace chunkstream {
+
+namespace {
+
+// Placed in front of every block to find its size class on release
+struct alignas(16) BlockHeader {
+  uint32_t magic;
+  uint32_t size_class;
+};
+
+const uint32_t BLOCK_MAGIC = 0x43534250; // "CSBP"
+const size_t BLOCK_HEADER_SIZE = sizeof(BlockHeader);
+const size_t SUBCLASS_COUNT = 4;         // Size classes per power of two
+const size_t SIZE_CLASS_COUNT = 64 * SUBCLASS_COUNT;
+
+size_t RoundUpPowerOfTwo(size_t size) {
+  size_t power = 1;
+  while (power < size) {
+    power <<= 1;
+  }
+  return power;
+}
+
+}
+
+SizeClassPool::SizeClassPool(size_t min_block_size, size_t max_block_size, size_t buffer_size,
+                             size_t max_total_bytes)
+  : BUFFER_SIZE(buffer_size),
+    // A power of two of at least SUBCLASS_COUNT, so that every class size is a whole number
+    MIN_BLOCK_SIZE(RoundUpPowerOfTwo(min_block_size > SUBCLASS_COUNT ? min_block_size : SUBCLASS_COUNT)),
+    MAX_BLOCK_SIZE(max_block_size),
+    MAX_TOTAL_BYTES(max_total_bytes) {
+  free_blocks_.resize(SIZE_CLASS_COUNT);
+  blocks_.reserve(BUFFER_SIZE);
+}
+
+// @return Pointer of reserved buffer which can hold `size` bytes, or nullptr if `size` exceeds
+//         `MAX_BLOCK_SIZE`, `BUFFER_SIZE` blocks are in use or the block would exceed `MAX_TOTAL_BYTES`.
+uint8_t* SizeClassPool::Acquire(size_t size) {
+  if (MAX_BLOCK_SIZE > 0 && size > MAX_BLOCK_SIZE) {
+    return nullptr;
+  }
+  const size_t size_class = __SizeClass(size);
+  if (size_class >= SIZE_CLASS_COUNT) {
+    return nullptr;
+  }
+  const size_t block_size = __BlockSize(size_class);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (used_count_ >= BUFFER_SIZE) {
+    return nullptr;
+  }
+
+  std::vector<uint8_t*>& free_blocks = free_blocks_[size_class];
+  if (!free_blocks.empty()) {
+    uint8_t* ptr = free_blocks.back();
+    free_blocks.pop_back();
+    used_count_++;
+    used_bytes_ += block_size;
+    peak_used_bytes_ = std::max(peak_used_bytes_, used_bytes_);
+    return ptr;
+  }
+
+  // First use of this size class (or all of its blocks are in use); blocks kept free
+  // for other classes make room first
+  if (MAX_TOTAL_BYTES > 0) {
+    __Trim(size_class, block_size, MAX_TOTAL_BYTES);
+    if (allocated_bytes_ + block_size > MAX_TOTAL_BYTES) {
+      return nullptr;
+    }
+  } else {
+    __Trim(size_class, block_size, 2 * std::max(peak_used_bytes_, used_bytes_ + block_size));
+  }
+
+  std::unique_ptr<uint8_t[]> block(new uint8_t[BLOCK_HEADER_SIZE + block_size]);
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(block.get());
+  header->magic = BLOCK_MAGIC;
+  header->size_class = static_cast<uint32_t>(size_class);
+
+  uint8_t* ptr = block.get() + BLOCK_HEADER_SIZE;
+  blocks_.push_back(std::move(block));
+  free_blocks.reserve(BUFFER_SIZE);
+  allocated_bytes_ += block_size;
+  used_count_++;
+  used_bytes_ += block_size;
+  peak_used_bytes_ = std::max(peak_used_bytes_, used_bytes_);
+  return ptr;
+}
+
+void SizeClassPool::Release(uint8_t* ptr) {
+  if (ptr == nullptr) return;
+
+  const BlockHeader* header = reinterpret_cast<const BlockHeader*>(ptr - BLOCK_HEADER_SIZE);
+
+  // Checks validation
+  if (header->magic != BLOCK_MAGIC || header->size_class >= SIZE_CLASS_COUNT) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_blocks_[header->size_class].push_back(ptr);
+  used_count_--;
+  used_bytes_ -= __BlockSize(header->size_class);
+}
+
+size_t SizeClassPool::GetUsedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return used_count_;
+}
+
+size_t SizeClassPool::GetAllocatedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocated_bytes_;
+}
+
+size_t SizeClassPool::__SizeClass(size_t size) const {
+  if (size <= MIN_BLOCK_SIZE) {
+    return 0;
+  }
+  // base < size <= 2 * base
+  size_t octave = 0;
+  size_t base = MIN_BLOCK_SIZE;
+  while (base < size - base) {
+    if (octave + 1 >= SIZE_CLASS_COUNT / SUBCLASS_COUNT) {
+      return SIZE_CLASS_COUNT;
+    }
+    base <<= 1;
+    octave++;
+  }
+  const size_t step = base / SUBCLASS_COUNT;
+  // 1 to SUBCLASS_COUNT; the latter is the first class of the next octave
+  const size_t subclass = (size - base + step - 1) / step;
+  return octave * SUBCLASS_COUNT + subclass;
+}
+
+size_t SizeClassPool::__BlockSize(size_t size_class) const {
+  const size_t base = MIN_BLOCK_SIZE << (size_class / SUBCLASS_COUNT);
+  return base + size_class % SUBCLASS_COUNT * (base / SUBCLASS_COUNT);
+}
+
+void SizeClassPool::__Trim(size_t size_class, size_t size, size_t limit) {
+  for (size_t other = SIZE_CLASS_COUNT; other-- > 0 && allocated_bytes_ + size > limit;) {
+    if (other == size_class) continue;
+    std::vector<uint8_t*>& free_blocks = free_blocks_[other];
+    while (!free_blocks.empty() && allocated_bytes_ + size > limit) {
+      uint8_t* ptr = free_blocks.back();
+      free_blocks.pop_back();
+      auto block = std::find_if(blocks_.begin(), blocks_.end(),
+        [ptr](const std::unique_ptr<uint8_t[]>& block) { return block.get() + BLOCK_HEADER_SIZE == ptr; });
+      std::swap(*block, blocks_.back());
+      blocks_.pop_back();
+      allocated_bytes_ -= __BlockSize(other);
+    }
+  }
+}
+
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Checks that the receive path does not allocate per frame once warmed up: frames are sent
+// chunk by chunk over loopback to a ZeroCopyReceiver running its own io_context, and heap
+// allocations are counted through a replaced global `operator new`.
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "chunkstream/receiver.h"
+#include "counting_allocator.h"
+
+using namespace chunkstream;
+
+constexpr int TEST_PORT = 56346;
+constexpr int MTU = 1500;
+constexpr size_t FRAME_SIZE = 100 * 1024;
+constexpr size_t WARMUP_FRAMES = 200;
+constexpr size_t MEASURED_FRAMES = 1000;
+
+// Sends every chunk of frame `id` and waits until the frame is delivered
+void SendFrame(asio::ip::udp::socket& socket, const asio::ip::udp::endpoint& receiver_endpoint,
+               const std::atomic<size_t>& frames, const uint32_t id,
+               const std::vector<uint8_t>& data, std::vector<uint8_t>& packet) {
+    const DynamicLayout layout(MTU);
+    const size_t total_chunks = layout.ChunkCount(data.size());
+    const size_t expected = frames + 1;
+
+    for (size_t i = 0; i < total_chunks; i++) {
+        ChunkHeader header;
+        header.id = id;
+        header.total_size = static_cast<uint32_t>(data.size());
+        header.total_chunks = static_cast<uint16_t>(total_chunks);
+        header.chunk_index = static_cast<uint16_t>(i);
+        header.chunk_size = static_cast<uint32_t>(
+            std::min<size_t>(layout.PAYLOAD, data.size() - layout.ChunkOffset(i)));
+        header.transmission_type = 0;
+        const ChunkHeader n_header = HostToNetwork(header);
+        std::memcpy(packet.data(), &n_header, CHUNKHEADER_SIZE);
+        std::memcpy(packet.data() + CHUNKHEADER_SIZE, data.data() + layout.ChunkOffset(i), header.chunk_size);
+        socket.send_to(asio::buffer(packet.data(), CHUNKHEADER_SIZE + header.chunk_size), receiver_endpoint);
+    }
+    // A lost datagram is recovered through a resend request, which this sender ignores
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (frames < expected && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+int main() {
+    std::atomic<size_t> frames{0};
+    std::atomic<size_t> corrupted{0};
+    std::vector<uint8_t> data(FRAME_SIZE);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> packet(DynamicLayout(MTU).PACKET_SIZE);
+
+    uint64_t allocations = 0;
+    try {
+        ZeroCopyReceiver receiver(TEST_PORT,
+            [&](FrameView frame) {
+                if (frame.GetSize() != data.size() || std::memcmp(frame.GetData(), data.data(), data.size()) != 0) {
+                    corrupted++;
+                }
+                frames++;
+            },
+            MTU, 16, FRAME_SIZE);
+        std::thread receiver_thread([&receiver]() { receiver.Start(); });
+
+        asio::io_context io_context;
+        asio::ip::udp::socket socket(io_context, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0));
+        const asio::ip::udp::endpoint receiver_endpoint(asio::ip::make_address("127.0.0.1"), TEST_PORT);
+
+        uint32_t id = 0;
+        for (size_t i = 0; i < WARMUP_FRAMES; i++) {
+            SendFrame(socket, receiver_endpoint, frames, id++, data, packet);
+        }
+        const uint64_t start = allocation_count.load();
+        for (size_t i = 0; i < MEASURED_FRAMES; i++) {
+            SendFrame(socket, receiver_endpoint, frames, id++, data, packet);
+        }
+        allocations = allocation_count.load() - start;
+
+        receiver.Stop();
+        receiver_thread.join();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "frames " << frames << ", corrupted " << corrupted
+              << ", allocations per frame " << static_cast<double>(allocations) / MEASURED_FRAMES << std::endl;
+    if (frames != WARMUP_FRAMES + MEASURED_FRAMES || corrupted != 0) {
+        std::cerr << "FAILED: frames were lost or corrupted" << std::endl;
+        return 1;
+    }
+    if (allocations != 0) {
+        std::cerr << "FAILED: " << allocations << " allocations in " << MEASURED_FRAMES << " frames" << std::endl;
+        return 1;
+    }
+    return 0;
+}
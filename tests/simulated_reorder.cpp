@@ -0,0 +1,108 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Checks that every frame is delivered exactly once over a simulated link which holds datagrams
+// back for longer than a resend takes: an original chunk arriving after its frame was completed
+// by resends and released must not start the frame again.
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7
+#endif
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "chunkstream/receiver.h"
+#include "chunkstream/sender.h"
+
+using namespace chunkstream;
+
+constexpr uint64_t SEED = 7;
+constexpr int MTU = 1500;
+constexpr size_t FRAME_SIZE = 16 * 1024;
+constexpr size_t FRAME_COUNT = 300;
+constexpr size_t SENDER_BUFFER_SIZE = 16;
+constexpr size_t RECEIVER_BUFFER_SIZE = 64; // Frames wait for resends of held back chunks
+
+int main() {
+    asio::io_context io_context;
+    auto work = asio::make_work_guard(io_context);
+    std::thread io_thread([&io_context]() { io_context.run(); });
+
+    std::vector<size_t> deliveries(FRAME_COUNT, 0);
+    size_t corrupted = 0;
+    std::mutex mutex;
+    ReceiverStats stats{};
+    {
+        SimulatedLink link(io_context.get_executor(), SEED);
+        const asio::ip::udp::endpoint receiver_endpoint(asio::ip::make_address("10.0.0.2"), 5000);
+        const asio::ip::udp::endpoint sender_endpoint(asio::ip::make_address("10.0.0.1"), 5000);
+
+        // Held back datagrams arrive after the resend of the chunk and often after the frame is released
+        SimulatedLink::Impairments impairments;
+        impairments.loss = 0.01;
+        impairments.reorder = 0.05;
+        impairments.reorder_delay = std::chrono::milliseconds(60);
+        link.SetImpairments(receiver_endpoint, impairments);
+
+        SimulatedReceiver receiver(std::make_unique<SimulatedSocket>(link, receiver_endpoint),
+            [&](FrameView frame) {
+                std::lock_guard<std::mutex> lock(mutex);
+                uint32_t index = 0;
+                if (frame.GetSize() != FRAME_SIZE) {
+                    corrupted++;
+                    return;
+                }
+                std::memcpy(&index, frame.GetData(), sizeof(index));
+                if (index >= FRAME_COUNT || frame.GetData()[FRAME_SIZE - 1] != static_cast<uint8_t>(index)) {
+                    corrupted++;
+                    return;
+                }
+                deliveries[index]++;
+            },
+            MTU, RECEIVER_BUFFER_SIZE);
+        SimulatedSender sender(std::make_unique<SimulatedSocket>(link, sender_endpoint),
+                               receiver_endpoint, MTU, SENDER_BUFFER_SIZE, FRAME_SIZE);
+        receiver.Start();
+        sender.Start();
+
+        std::vector<uint8_t> data(FRAME_SIZE);
+        for (uint32_t index = 0; index < FRAME_COUNT; index++) {
+            std::memcpy(data.data(), &index, sizeof(index));
+            data[FRAME_SIZE - 1] = static_cast<uint8_t>(index);
+            sender.Send(data.data(), data.size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        // Long enough for the last resends and the held back datagrams
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        sender.Stop();
+        receiver.Stop();
+        stats = receiver.GetStats();
+    }
+    work.reset();
+    io_context.stop();
+    io_thread.join();
+
+    size_t missing = 0;
+    size_t repeated = 0;
+    for (const size_t count : deliveries) {
+        if (count == 0) missing++;
+        if (count > 1) repeated++;
+    }
+    std::cout << "frames " << FRAME_COUNT << ", missing " << missing << ", repeated " << repeated
+              << ", corrupted " << corrupted << ", late chunks " << stats.late_chunks << std::endl;
+    if (missing != 0 || repeated != 0 || corrupted != 0) {
+        std::cerr << "FAILED: every frame must be delivered exactly once" << std::endl;
+        return 1;
+    }
+    return 0;
+}
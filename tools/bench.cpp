@@ -0,0 +1,412 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Runs a sender and a receiver over loopback, or over a simulated lossy link,
+// for a fixed duration and prints throughput, latency, drops and CPU cost as one JSON object.
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chunkstream/sender.h"
+#include "chunkstream/receiver.h"
+
+using namespace chunkstream;
+
+constexpr int DEFAULT_BENCH_PORT = 56344;
+
+// Command line argument parsing
+struct CommandLineArgs {
+    size_t frame_size = 1024 * 1024;
+    int mtu = 1500;
+    double rate = 0;               // Frames per second; 0 sends as fast as backpressure allows
+    double duration = 5;           // Seconds
+    size_t batch = 1;              // Frames sent back-to-back per rate tick
+    std::string engine = "zerocopy";
+    size_t buffer_size = 64;
+    int port = DEFAULT_BENCH_PORT;
+    SimulatedLink::Impairments impairments;  // `simulated` engine only
+    uint64_t seed = 1;
+    bool help = false;
+};
+
+// Updated by the receiver's handler
+struct Measurements {
+    std::atomic<size_t> frames_received{0};
+    std::atomic<size_t> bytes_received{0};
+    std::atomic<int64_t> last_receive_ns{0};
+    Histogram latency;             // Send() call to delivery, ns
+};
+
+int64_t NowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double CpuSeconds() {
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+CommandLineArgs ParseArguments(int argc, char* argv[]) {
+    CommandLineArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        try {
+            if (arg == "--help" || arg == "-h") {
+                args.help = true;
+            }
+            else if (arg == "--frame-size" && i + 1 < argc) {
+                args.frame_size = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--mtu" && i + 1 < argc) {
+                args.mtu = std::stoi(argv[++i]);
+            }
+            else if (arg == "--rate" && i + 1 < argc) {
+                args.rate = std::stod(argv[++i]);
+            }
+            else if (arg == "--unthrottled") {
+                args.rate = 0;
+            }
+            else if (arg == "--duration" && i + 1 < argc) {
+                args.duration = std::stod(argv[++i]);
+            }
+            else if (arg == "--batch" && i + 1 < argc) {
+                args.batch = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--engine" && i + 1 < argc) {
+                args.engine = argv[++i];
+            }
+            else if (arg == "--buffer-size" && i + 1 < argc) {
+                args.buffer_size = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--port" && i + 1 < argc) {
+                args.port = std::stoi(argv[++i]);
+            }
+            else if (arg == "--loss" && i + 1 < argc) {
+                args.impairments.loss = std::stod(argv[++i]);
+            }
+            else if (arg == "--burst-start" && i + 1 < argc) {
+                args.impairments.burst_start = std::stod(argv[++i]);
+            }
+            else if (arg == "--burst-end" && i + 1 < argc) {
+                args.impairments.burst_end = std::stod(argv[++i]);
+            }
+            else if (arg == "--burst-loss" && i + 1 < argc) {
+                args.impairments.burst_loss = std::stod(argv[++i]);
+            }
+            else if (arg == "--reorder" && i + 1 < argc) {
+                args.impairments.reorder = std::stod(argv[++i]);
+            }
+            else if (arg == "--duplicate" && i + 1 < argc) {
+                args.impairments.duplicate = std::stod(argv[++i]);
+            }
+            else if (arg == "--delay-us" && i + 1 < argc) {
+                args.impairments.delay = std::chrono::microseconds(std::stoll(argv[++i]));
+            }
+            else if (arg == "--jitter-us" && i + 1 < argc) {
+                args.impairments.jitter = std::chrono::microseconds(std::stoll(argv[++i]));
+            }
+            else if (arg == "--bandwidth-mbps" && i + 1 < argc) {
+                args.impairments.bandwidth = static_cast<uint64_t>(std::stod(argv[++i]) * 1e6);
+            }
+            else if (arg == "--seed" && i + 1 < argc) {
+                args.seed = std::stoull(argv[++i]);
+            }
+            else {
+                std::cerr << "Error: Unknown argument: " << arg << std::endl;
+                args.help = true;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << std::endl;
+            args.help = true;
+        }
+    }
+
+    if (args.frame_size < sizeof(int64_t)) {
+        std::cerr << "Error: --frame-size must be at least " << sizeof(int64_t) << " bytes" << std::endl;
+        args.help = true;
+    }
+    if (args.batch == 0 || args.buffer_size == 0 || args.duration <= 0 || args.rate < 0) {
+        std::cerr << "Error: --batch, --buffer-size and --duration must be positive" << std::endl;
+        args.help = true;
+    }
+    if (args.engine != "callback" && args.engine != "zerocopy"
+        && args.engine != "pull" && args.engine != "recvmsg" && args.engine != "simulated") {
+        std::cerr << "Error: Unknown engine: " << args.engine << std::endl;
+        args.help = true;
+    }
+
+    return args;
+}
+
+void PrintUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Sends frames over loopback for DURATION seconds and prints the results as JSON." << std::endl;
+    std::cout << std::endl;
+    std::cout << "OPTIONS:" << std::endl;
+    std::cout << "  --frame-size BYTES   Frame size (default: 1048576)" << std::endl;
+    std::cout << "  --mtu N              MTU (default: 1500)" << std::endl;
+    std::cout << "  --rate FPS           Target frames per second (default: unthrottled)" << std::endl;
+    std::cout << "  --unthrottled        Send as fast as the sender's buffer allows" << std::endl;
+    std::cout << "  --duration SECONDS   Sending time (default: 5)" << std::endl;
+    std::cout << "  --batch N            Frames sent back-to-back per rate tick (default: 1)" << std::endl;
+    std::cout << "  --engine NAME        Receiving path (default: zerocopy)" << std::endl;
+    std::cout << "                         callback  Receiver, frames copied into a vector" << std::endl;
+    std::cout << "                         zerocopy  ZeroCopyReceiver, frames read in place" << std::endl;
+    std::cout << "                         pull      PullReceiver, frames taken by a consumer thread" << std::endl;
+    std::cout << "                         recvmsg   ZeroCopyReceiver with kernel timestamps (Linux)" << std::endl;
+    std::cout << "                         simulated SimulatedReceiver on an in-memory link with the impairments below" << std::endl;
+    std::cout << "  --buffer-size N      Frames buffered by sender and receiver (default: 64)" << std::endl;
+    std::cout << "  --port N             UDP port (default: " << DEFAULT_BENCH_PORT << ")" << std::endl;
+    std::cout << std::endl;
+    std::cout << "SIMULATED LINK (--engine simulated):" << std::endl;
+    std::cout << "  --loss P             Random loss probability (default: 0)" << std::endl;
+    std::cout << "  --burst-start P      Gilbert-Elliott good to bad state probability (default: 0)" << std::endl;
+    std::cout << "  --burst-end P        Gilbert-Elliott bad to good state probability (default: 1)" << std::endl;
+    std::cout << "  --burst-loss P       Loss probability in the bad state (default: 1)" << std::endl;
+    std::cout << "  --reorder P          Probability that a packet is held back by 500 us (default: 0)" << std::endl;
+    std::cout << "  --duplicate P        Duplication probability (default: 0)" << std::endl;
+    std::cout << "  --delay-us N         One-way delay (default: 0)" << std::endl;
+    std::cout << "  --jitter-us N        Uniform extra delay (default: 0)" << std::endl;
+    std::cout << "  --bandwidth-mbps N   Bandwidth cap (default: none)" << std::endl;
+    std::cout << "  --seed N             Seed of the drop, reorder and duplicate draws; timing still varies (default: 1)" << std::endl;
+    std::cout << "  --help, -h           Show this help message" << std::endl;
+}
+
+void RecordFrame(Measurements& measurements, const uint8_t* data, const size_t size) {
+    const int64_t now = NowNanoseconds();
+    int64_t send_ns;
+    std::memcpy(&send_ns, data, sizeof(send_ns));
+    measurements.latency.Record(now > send_ns ? static_cast<uint64_t>(now - send_ns) : 0);
+    measurements.frames_received++;
+    measurements.bytes_received += size;
+    measurements.last_receive_ns = now;
+}
+
+// Sends for `args.duration`, then waits for the last frames to arrive or drop
+template<typename ReceiverType, typename SenderType>
+void RunBenchmark(const CommandLineArgs& args, ReceiverType& receiver, SenderType& sender,
+                  int64_t* start_ns, int64_t* end_send_ns) {
+    std::thread receiver_thread([&receiver]() { receiver.Start(); });
+    std::thread sender_thread([&sender]() { sender.Start(); });
+
+    std::vector<uint8_t> frame(args.frame_size);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = static_cast<uint8_t>(i);
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::time_point end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(args.duration));
+    const std::chrono::steady_clock::duration tick = args.rate > 0
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(args.batch / args.rate))
+        : std::chrono::steady_clock::duration::zero();
+    *start_ns = NowNanoseconds();
+
+    std::chrono::steady_clock::time_point next_tick = start;
+    while (std::chrono::steady_clock::now() < end) {
+        for (size_t i = 0; i < args.batch; i++) {
+            const int64_t send_ns = NowNanoseconds();
+            std::memcpy(frame.data(), &send_ns, sizeof(send_ns));
+            sender.Send(frame.data(), frame.size());
+        }
+        if (tick.count() > 0) {
+            next_tick += tick;
+            std::this_thread::sleep_until(next_tick);
+        }
+    }
+    *end_send_ns = NowNanoseconds();
+
+    // Resends and frame drops settle within the receiver's drop timeout
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    sender.Stop();
+    sender_thread.join();
+    receiver.Stop();
+    receiver_thread.join();
+}
+
+void PrintJson(const CommandLineArgs& args, Measurements& measurements,
+               const SenderStats& sent, const ReceiverStats& received, const SimulatedLink::Stats* link,
+               const int64_t start_ns, const int64_t end_send_ns, const double cpu_seconds) {
+    const size_t frames = measurements.frames_received;
+    const size_t bytes = measurements.bytes_received;
+    const int64_t end_ns = std::max<int64_t>(measurements.last_receive_ns, end_send_ns);
+    const double seconds = static_cast<double>(end_ns - start_ns) / 1e9;
+    const double gigabytes = static_cast<double>(bytes) / 1e9;
+    const Histogram& latency = measurements.latency;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "{\n"
+              << "  \"config\": {\"frame_size\": " << args.frame_size
+              << ", \"mtu\": " << args.mtu
+              << ", \"rate\": " << args.rate
+              << ", \"duration\": " << args.duration
+              << ", \"batch\": " << args.batch
+              << ", \"engine\": \"" << args.engine << "\""
+              << ", \"buffer_size\": " << args.buffer_size;
+    if (link) {
+        const SimulatedLink::Impairments& impairments = args.impairments;
+        std::cout << ", \"loss\": " << impairments.loss
+                  << ", \"burst_start\": " << impairments.burst_start
+                  << ", \"burst_end\": " << impairments.burst_end
+                  << ", \"burst_loss\": " << impairments.burst_loss
+                  << ", \"reorder\": " << impairments.reorder
+                  << ", \"duplicate\": " << impairments.duplicate
+                  << ", \"delay_us\": " << impairments.delay.count()
+                  << ", \"jitter_us\": " << impairments.jitter.count()
+                  << ", \"bandwidth_mbps\": " << impairments.bandwidth / 1e6
+                  << ", \"seed\": " << args.seed;
+    }
+    std::cout << "},\n"
+              << "  \"frames_sent\": " << sent.frames_sent << ",\n"
+              << "  \"frames_received\": " << frames << ",\n"
+              << "  \"bytes_received\": " << bytes << ",\n"
+              << "  \"seconds\": " << seconds << ",\n"
+              << "  \"throughput_fps\": " << (seconds > 0 ? frames / seconds : 0) << ",\n"
+              << "  \"throughput_gbps\": " << (seconds > 0 ? bytes * 8 / seconds / 1e9 : 0) << ",\n"
+              << "  \"latency_us\": {"
+              << "\"p50\": " << latency.GetPercentile(50) / 1e3
+              << ", \"p99\": " << latency.GetPercentile(99) / 1e3
+              << ", \"p999\": " << latency.GetPercentile(99.9) / 1e3
+              << ", \"max\": " << latency.GetMax() / 1e3 << "},\n"
+              << "  \"drops\": {"
+              << "\"frames_lost\": " << (sent.frames_sent > frames ? sent.frames_sent - frames : 0)
+              << ", \"frames_timed_out\": " << received.frames_timed_out
+              << ", \"frames_abandoned\": " << received.frames_abandoned
+              << ", \"no_buffer_chunks\": " << received.no_buffer_chunks
+              << ", \"kernel_drops\": " << received.kernel_drops << "},\n"
+              << "  \"resend_requests\": " << received.resend_requests_sent << ",\n"
+              << "  \"resends_served\": " << sent.resends_served << ",\n";
+    if (link) {
+        std::cout << "  \"link\": {"
+                  << "\"datagrams_sent\": " << link->datagrams_sent
+                  << ", \"delivered\": " << link->datagrams_delivered
+                  << ", \"lost\": " << link->lost
+                  << ", \"burst_lost\": " << link->burst_lost
+                  << ", \"queue_dropped\": " << link->queue_dropped
+                  << ", \"duplicated\": " << link->duplicated
+                  << ", \"reordered\": " << link->reordered
+                  << ", \"socket_overflows\": " << link->socket_overflows << "},\n";
+    }
+    std::cout
+              << "  \"cpu_seconds\": " << cpu_seconds << ",\n"
+              << "  \"cpu_seconds_per_gb\": " << (gigabytes > 0 ? cpu_seconds / gigabytes : 0) << "\n"
+              << "}" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    CommandLineArgs args = ParseArguments(argc, argv);
+    if (args.help) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+
+    Measurements measurements;
+    SenderStats sent;
+    ReceiverStats received;
+    int64_t start_ns = 0;
+    int64_t end_send_ns = 0;
+    SimulatedLink::Stats link_stats;
+    const bool simulated = args.engine == "simulated";
+    const double cpu_start = CpuSeconds();
+
+    try {
+        if (simulated) {
+            // Impairs the data direction only; resend requests get through
+            asio::io_context io_context;
+            asio::executor_work_guard<asio::io_context::executor_type> work(io_context.get_executor());
+            std::thread link_thread([&io_context]() { io_context.run(); });
+            {
+                SimulatedLink link(io_context.get_executor(), args.seed);
+                const asio::ip::udp::endpoint receiver_endpoint(asio::ip::make_address("10.0.0.2"), args.port);
+                link.SetImpairments(receiver_endpoint, args.impairments);
+
+                SimulatedReceiver receiver(std::make_unique<SimulatedSocket>(link, receiver_endpoint),
+                    [&measurements](FrameView frame) {
+                        RecordFrame(measurements, frame.GetData(), frame.GetSize());
+                    },
+                    args.mtu, args.buffer_size, args.frame_size);
+                SimulatedSender sender(
+                    std::make_unique<SimulatedSocket>(link, asio::ip::udp::endpoint(asio::ip::make_address("10.0.0.1"), 0)),
+                    receiver_endpoint, args.mtu, args.buffer_size, args.frame_size);
+                RunBenchmark(args, receiver, sender, &start_ns, &end_send_ns);
+                received = receiver.GetStats();
+                sent = sender.GetStats();
+                link_stats = link.GetStats();
+            }
+            work.reset();
+            io_context.stop();
+            link_thread.join();
+            PrintJson(args, measurements, sent, received, &link_stats, start_ns, end_send_ns, CpuSeconds() - cpu_start);
+            return 0;
+        }
+
+        Sender sender("127.0.0.1", args.port, args.mtu, args.buffer_size, args.frame_size);
+
+        if (args.engine == "callback") {
+            Receiver receiver(args.port,
+                [&measurements](const std::vector<uint8_t>& data, std::function<void()> release) {
+                    RecordFrame(measurements, data.data(), data.size());
+                    release();
+                },
+                args.mtu, args.buffer_size, args.frame_size);
+            RunBenchmark(args, receiver, sender, &start_ns, &end_send_ns);
+            received = receiver.GetStats();
+        }
+        else if (args.engine == "pull") {
+            FrameQueue queue(args.buffer_size);
+            PullReceiver receiver(args.port, std::ref(queue), args.mtu, args.buffer_size, args.frame_size);
+            std::atomic<bool> consuming{true};
+            std::thread consumer([&]() {
+                while (consuming) {
+                    FrameView frame = queue.Receive(std::chrono::milliseconds(100));
+                    if (frame) {
+                        RecordFrame(measurements, frame.GetData(), frame.GetSize());
+                    }
+                }
+            });
+            RunBenchmark(args, receiver, sender, &start_ns, &end_send_ns);
+            consuming = false;
+            consumer.join();
+            received = receiver.GetStats();
+        }
+        else {
+            ZeroCopyReceiver receiver(args.port,
+                [&measurements](FrameView frame) {
+                    RecordFrame(measurements, frame.GetData(), frame.GetSize());
+                },
+                args.mtu, args.buffer_size, args.frame_size);
+            if (args.engine == "recvmsg" && !receiver.SetKernelTimestamps(true)) {
+                return 1;
+            }
+            RunBenchmark(args, receiver, sender, &start_ns, &end_send_ns);
+            received = receiver.GetStats();
+        }
+        sent = sender.GetStats();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    PrintJson(args, measurements, sent, received, nullptr, start_ns, end_send_ns, CpuSeconds() - cpu_start);
+    return 0;
+}
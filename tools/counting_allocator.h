@@ -0,0 +1,147 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Replaces every global `operator new` and `operator delete` to count heap allocations.
+// All of them allocate with `std::malloc` and free with `std::free` through `CountedAllocate()` and
+// `CountedFree()`, so that no pointer of the standard allocator reaches a replaced `delete`.
+// Defines the replacements, so include it from exactly one source file of a program.
+
+#ifndef CHUNKSTREAM_TOOLS_COUNTING_ALLOCATOR_H_
+#define CHUNKSTREAM_TOOLS_COUNTING_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Out of line, so that the compiler does not pair `std::free` with an inlined `operator new`
+#if defined(__GNUC__) || defined(__clang__)
+#define CHUNKSTREAM_COUNTING_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define CHUNKSTREAM_COUNTING_NOINLINE __declspec(noinline)
+#else
+#define CHUNKSTREAM_COUNTING_NOINLINE
+#endif
+
+// Heap allocations, counted by the replaced global `operator new`
+std::atomic<uint64_t> allocation_count{0};
+
+// @return Block of `size` bytes aligned to `alignment`, or nullptr if out of memory.
+//         The pointer `std::malloc` returned is stored in front of over-aligned blocks.
+CHUNKSTREAM_COUNTING_NOINLINE void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+    void* raw = std::malloc(size + alignment + sizeof(void*));
+    if (!raw) {
+        return nullptr;
+    }
+    const uintptr_t address = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+    void* ptr = reinterpret_cast<void*>((address + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    static_cast<void**>(ptr)[-1] = raw;
+    return ptr;
+}
+
+CHUNKSTREAM_COUNTING_NOINLINE void CountedFree(void* ptr, std::size_t alignment) {
+    if (!ptr) {
+        return;
+    }
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        std::free(ptr);
+    } else {
+        std::free(static_cast<void**>(ptr)[-1]);
+    }
+}
+
+void* operator new(std::size_t size) {
+    if (void* ptr = CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = CountedAllocate(size, static_cast<std::size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* ptr) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    CountedFree(ptr, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    CountedFree(ptr, static_cast<std::size_t>(alignment));
+}
+
+#endif
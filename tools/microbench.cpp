@@ -0,0 +1,365 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Microbenchmarks of the core data structures and hot functions, reporting
+// nanoseconds and heap allocations per operation.
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chunkstream/sender.h"
+#include "chunkstream/receiver.h"
+#include "counting_allocator.h"
+
+using namespace chunkstream;
+
+constexpr int MICROBENCH_PORT = 56345;
+
+// Command line argument parsing
+struct CommandLineArgs {
+    bool ci = false;               // Every benchmark once with a small fixed count
+    std::string filter;            // Only benchmarks whose name contains it
+    size_t min_time_ms = 200;
+    size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    bool help = false;
+};
+
+struct Result {
+    std::string name;
+    uint64_t ops = 0;
+    double ns_per_op = 0;
+    double allocations_per_op = 0;
+};
+
+// Runs `ops` operations and returns the nanoseconds they took
+using Body = std::function<uint64_t(uint64_t ops)>;
+
+// Keeps the compiler from optimizing away a computed value
+template<typename T>
+void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+uint64_t ElapsedNanoseconds(const std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+CommandLineArgs ParseArguments(int argc, char* argv[]) {
+    CommandLineArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        try {
+            if (arg == "--help" || arg == "-h") {
+                args.help = true;
+            }
+            else if (arg == "--ci") {
+                args.ci = true;
+            }
+            else if (arg == "--filter" && i + 1 < argc) {
+                args.filter = argv[++i];
+            }
+            else if (arg == "--min-time" && i + 1 < argc) {
+                args.min_time_ms = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--threads" && i + 1 < argc) {
+                args.max_threads = std::max<size_t>(std::stoul(argv[++i]), 1);
+            }
+            else {
+                std::cerr << "Error: Unknown argument: " << arg << std::endl;
+                args.help = true;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << std::endl;
+            args.help = true;
+        }
+    }
+
+    return args;
+}
+
+void PrintUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "OPTIONS:" << std::endl;
+    std::cout << "  --ci             Run every benchmark once with a small count, e.g. as a CI smoke test" << std::endl;
+    std::cout << "  --filter TEXT    Only benchmarks whose name contains TEXT" << std::endl;
+    std::cout << "  --min-time MS    Minimum time per benchmark (default: 200)" << std::endl;
+    std::cout << "  --threads N      Most threads for the memory pool benchmark (default: hardware threads)" << std::endl;
+    std::cout << "  --help, -h       Show this help message" << std::endl;
+}
+
+// Doubles the operation count until a run takes `min_time_ms`, or runs `ci_ops` once
+Result Measure(const CommandLineArgs& args, const std::string& name, const uint64_t ci_ops, const Body& body) {
+    Result result;
+    result.name = name;
+    body(1); // Warms up pools and caches
+
+    uint64_t ops = args.ci ? ci_ops : 1;
+    while (true) {
+        const uint64_t allocations = allocation_count.load(std::memory_order_relaxed);
+        const uint64_t ns = body(ops);
+        const uint64_t allocated = allocation_count.load(std::memory_order_relaxed) - allocations;
+        if (args.ci || ns >= args.min_time_ms * 1000000 || ops >= (uint64_t(1) << 40)) {
+            result.ops = ops;
+            result.ns_per_op = static_cast<double>(ns) / ops;
+            result.allocations_per_op = static_cast<double>(allocated) / ops;
+            return result;
+        }
+        ops *= 2;
+    }
+}
+
+// Acquire/Release pairs from `threads` threads at once; ns/op is wall time per pair
+Body MemoryPoolBody(MemoryPool& pool, const size_t threads) {
+    return [&pool, threads](uint64_t ops) {
+        const uint64_t ops_per_thread = std::max<uint64_t>(ops / threads, 1);
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&pool, &ready, &go, ops_per_thread]() {
+                ready++;
+                while (!go) std::this_thread::yield();
+                for (uint64_t i = 0; i < ops_per_thread; i++) {
+                    uint8_t* block = pool.Acquire();
+                    DoNotOptimize(block);
+                    if (block) pool.Release(block);
+                }
+            });
+        }
+        while (ready < threads) std::this_thread::yield();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        go = true;
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        return ElapsedNanoseconds(start) * ops / (ops_per_thread * threads);
+    };
+}
+
+// Sliding window of frame ids, as kept by the receiver's `assembling_queue_`
+Body OrderedHashContainerWindowBody(const size_t window) {
+    return [window](uint64_t ops) {
+        OrderedHashContainer<uint32_t, uint32_t> container;
+        container.reserve(window);
+        uint32_t id = 0;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ops; i++) {
+            container.push_back(id, id);
+            if (container.size() > window) {
+                container.erase(id - static_cast<uint32_t>(window));
+            }
+            id++;
+        }
+        return ElapsedNanoseconds(start);
+    };
+}
+
+Body OrderedHashContainerFindBody(const size_t window) {
+    return [window](uint64_t ops) {
+        OrderedHashContainer<uint32_t, uint32_t> container;
+        container.reserve(window);
+        for (uint32_t id = 0; id < window; id++) {
+            container.push_back(id, id);
+        }
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ops; i++) {
+            uint32_t* value = container.find(static_cast<uint32_t>(i % window));
+            DoNotOptimize(value);
+        }
+        return ElapsedNanoseconds(start);
+    };
+}
+
+// Stands in for the receiver, so frames can be assembled without a socket
+struct BenchOwner {
+    using LayoutType = DynamicLayout;
+    using Frame = BasicReceivingFrame<BenchOwner>;
+
+    size_t grabbed = 0;
+
+    void __RequestResend(const ChunkHeader, const asio::ip::udp::endpoint) {}
+    void __FrameGrabbed(Frame*) { grabbed++; }
+    void __FrameProgress(Frame*, const size_t) {}
+    void __FrameDropped(const uint32_t, uint8_t*) {}
+};
+
+// One op is one `AddChunk()`; frames of `total_chunks` are assembled in order, including their `Reset()`
+Body AddChunkBody(const size_t total_chunks) {
+    return [total_chunks](uint64_t ops) {
+        asio::io_context io_context;
+        const DynamicLayout layout(1500);
+        BenchOwner owner;
+        BenchOwner::Frame frame(io_context.get_executor(), layout, &owner);
+        const size_t total_size = total_chunks * layout.PAYLOAD;
+        std::vector<uint8_t> data(total_size);
+        std::vector<uint8_t> payload(layout.PAYLOAD, 0x5a);
+        const uint64_t frames = std::max<uint64_t>((ops + total_chunks - 1) / total_chunks, 1);
+
+        ChunkHeader header = {};
+        header.total_size = static_cast<uint32_t>(total_size);
+        header.total_chunks = static_cast<uint16_t>(total_chunks);
+        header.chunk_size = static_cast<uint32_t>(layout.PAYLOAD);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t f = 0; f < frames; f++) {
+            header.id = static_cast<uint32_t>(f);
+            frame.Reset(asio::ip::udp::endpoint(), header.id, total_chunks, total_size, data.data());
+            for (size_t i = 0; i < total_chunks; i++) {
+                header.chunk_index = static_cast<uint16_t>(i);
+                frame.AddChunk(header, payload.data());
+            }
+            io_context.poll(); // Cancelled timer waits
+        }
+        const uint64_t ns = ElapsedNanoseconds(start);
+        DoNotOptimize(owner.grabbed);
+        return ns * ops / (frames * total_chunks);
+    };
+}
+
+Body HeaderEncodeBody() {
+    return [](uint64_t ops) {
+        uint8_t packet[CHUNKHEADER_SIZE];
+        ChunkHeader header = {};
+        header.total_size = 1 << 20;
+        header.total_chunks = 713;
+        header.chunk_size = 1472;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ops; i++) {
+            header.id = static_cast<uint32_t>(i);
+            header.chunk_index = static_cast<uint16_t>(i);
+            const ChunkHeader n_header = HostToNetwork(header);
+            std::memcpy(packet, &n_header, CHUNKHEADER_SIZE);
+            DoNotOptimize(packet);
+        }
+        return ElapsedNanoseconds(start);
+    };
+}
+
+Body HeaderDecodeBody() {
+    return [](uint64_t ops) {
+        ChunkHeader source = {};
+        source.id = 7;
+        source.total_size = 1 << 20;
+        source.total_chunks = 713;
+        source.chunk_size = 1472;
+        uint8_t packet[CHUNKHEADER_SIZE];
+        const ChunkHeader n_source = HostToNetwork(source);
+        std::memcpy(packet, &n_source, CHUNKHEADER_SIZE);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ops; i++) {
+            DoNotOptimize(packet);
+            ChunkHeader header;
+            std::memcpy(&header, packet, CHUNKHEADER_SIZE);
+            NetworkToHost(&header);
+            DoNotOptimize(header);
+        }
+        return ElapsedNanoseconds(start);
+    };
+}
+
+// One op is one `Send()` of a `frame_size` frame, to a loopback port nobody listens on
+Body SenderSendBody(Sender& sender, const size_t frame_size) {
+    return [&sender, frame_size](uint64_t ops) {
+        std::vector<uint8_t> frame(frame_size, 0x5a);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < ops; i++) {
+            sender.Send(frame.data(), frame.size());
+        }
+        return ElapsedNanoseconds(start);
+    };
+}
+
+void PrintResult(const Result& result) {
+    std::cout << std::left << std::setw(52) << result.name << std::right
+              << std::setw(14) << result.ops
+              << std::setw(14) << std::fixed << std::setprecision(1) << result.ns_per_op
+              << std::setw(14) << std::setprecision(3) << result.allocations_per_op << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    CommandLineArgs args = ParseArguments(argc, argv);
+    if (args.help) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+
+    std::vector<std::pair<std::string, std::function<Result()>>> benchmarks;
+
+    MemoryPool pool(1500, 64);
+    for (size_t threads = 1; threads <= args.max_threads; threads *= 2) {
+        benchmarks.emplace_back("memory_pool/acquire_release/threads:" + std::to_string(threads),
+            [&args, &pool, threads]() {
+                return Measure(args, "memory_pool/acquire_release/threads:" + std::to_string(threads),
+                               10000, MemoryPoolBody(pool, threads));
+            });
+    }
+    for (const size_t window : {16, 256}) {
+        const std::string suffix = "/window:" + std::to_string(window);
+        benchmarks.emplace_back("ordered_hash_container/push_back_erase" + suffix, [&args, window, suffix]() {
+            return Measure(args, "ordered_hash_container/push_back_erase" + suffix, 10000,
+                           OrderedHashContainerWindowBody(window));
+        });
+        benchmarks.emplace_back("ordered_hash_container/find" + suffix, [&args, window, suffix]() {
+            return Measure(args, "ordered_hash_container/find" + suffix, 10000,
+                           OrderedHashContainerFindBody(window));
+        });
+    }
+    for (const size_t chunks : {10, 100, 1000, 10000, 65535}) {
+        const std::string name = "receiving_frame/add_chunk/chunks:" + std::to_string(chunks);
+        benchmarks.emplace_back(name, [&args, chunks, name]() {
+            return Measure(args, name, chunks, AddChunkBody(chunks));
+        });
+    }
+    benchmarks.emplace_back("chunk_header/encode", [&args]() {
+        return Measure(args, "chunk_header/encode", 10000, HeaderEncodeBody());
+    });
+    benchmarks.emplace_back("chunk_header/decode", [&args]() {
+        return Measure(args, "chunk_header/decode", 10000, HeaderDecodeBody());
+    });
+    for (const size_t frame_size : {64 * 1024, 1024 * 1024}) {
+        const std::string name = "sender/send/bytes:" + std::to_string(frame_size);
+        benchmarks.emplace_back(name, [&args, frame_size, name]() {
+            Sender sender("127.0.0.1", MICROBENCH_PORT, 1500, 16, frame_size);
+            std::thread sender_thread([&sender]() { sender.Start(); });
+            const Result result = Measure(args, name, 16, SenderSendBody(sender, frame_size));
+            sender.Stop();
+            sender_thread.join();
+            return result;
+        });
+    }
+
+    std::cout << std::left << std::setw(52) << "benchmark" << std::right
+              << std::setw(14) << "ops" << std::setw(14) << "ns/op" << std::setw(14) << "allocs/op" << std::endl;
+    for (const auto& benchmark : benchmarks) {
+        if (!args.filter.empty() && benchmark.first.find(args.filter) == std::string::npos) {
+            continue;
+        }
+        PrintResult(benchmark.second());
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Feeds the datagrams of a capture (`Receiver::SetCapture()` or tcpdump) into a receiver,
+// at their original pacing or as fast as possible, and reports the frames it assembles.
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601  // Windows 7
+#endif
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "chunkstream/receiver.h"
+
+using namespace chunkstream;
+
+// After the last datagram, a frame still assembling requests resends after the receiver's
+// INIT_CHUNK_TIMEOUT (20 ms) and is dropped FRAME_DROP_TIMEOUT (100 ms) later; wait well past both
+const std::chrono::milliseconds DRAIN_TIME(1000);
+
+// Command line argument parsing
+struct CommandLineArgs {
+    std::string path;
+    bool fast = false;
+    double speed = 1;              // Pacing factor; 2 replays twice as fast
+    int port = 0;                  // Only datagrams to this port; 0 for all
+    int mtu = 1500;
+    size_t buffer_size = 64;
+    size_t max_data_size = 0;
+    bool verbose = false;
+    bool help = false;
+};
+
+CommandLineArgs ParseArguments(int argc, char* argv[]) {
+    CommandLineArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        try {
+            if (arg == "--help" || arg == "-h") {
+                args.help = true;
+            }
+            else if (arg == "--fast") {
+                args.fast = true;
+            }
+            else if (arg == "--speed" && i + 1 < argc) {
+                args.speed = std::stod(argv[++i]);
+            }
+            else if (arg == "--port" && i + 1 < argc) {
+                args.port = std::stoi(argv[++i]);
+            }
+            else if (arg == "--mtu" && i + 1 < argc) {
+                args.mtu = std::stoi(argv[++i]);
+            }
+            else if (arg == "--buffer-size" && i + 1 < argc) {
+                args.buffer_size = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--max-data-size" && i + 1 < argc) {
+                args.max_data_size = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--verbose" || arg == "-v") {
+                args.verbose = true;
+            }
+            else if (args.path.empty() && arg[0] != '-') {
+                args.path = arg;
+            }
+            else {
+                std::cerr << "Error: Unknown argument: " << arg << std::endl;
+                args.help = true;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << std::endl;
+            args.help = true;
+        }
+    }
+    if (args.path.empty()) {
+        args.help = true;
+    }
+    if (args.speed <= 0 || args.buffer_size == 0) {
+        std::cerr << "Error: --speed and --buffer-size must be positive" << std::endl;
+        args.help = true;
+    }
+
+    return args;
+}
+
+void PrintUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " CAPTURE [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Replays the UDP datagrams of a pcap file into a receiver and prints what it assembled." << std::endl;
+    std::cout << "Resend requests are counted but not sent anywhere." << std::endl;
+    std::cout << std::endl;
+    std::cout << "OPTIONS:" << std::endl;
+    std::cout << "  --fast               As fast as the receiver takes them, instead of the original pacing" << std::endl;
+    std::cout << "  --speed FACTOR       Pacing factor, e.g. 2 for twice as fast (default: 1)" << std::endl;
+    std::cout << "  --port N             Only datagrams to port N (default: all)" << std::endl;
+    std::cout << "  --mtu N              MTU of the captured stream (default: 1500)" << std::endl;
+    std::cout << "  --buffer-size N      Frames buffered by the receiver (default: 64)" << std::endl;
+    std::cout << "  --max-data-size N    Largest frame size (default: unlimited)" << std::endl;
+    std::cout << "  --verbose, -v        Print one line per frame" << std::endl;
+    std::cout << "  --help, -h           Show this help message" << std::endl;
+}
+
+double Milliseconds(const std::chrono::system_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char* argv[]) {
+    CommandLineArgs args = ParseArguments(argc, argv);
+    if (args.help) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+
+    CaptureReader reader(args.path);
+    if (!reader.IsOpen()) {
+        return 1;
+    }
+
+    std::atomic<size_t> frames_received{0};
+    std::atomic<size_t> bytes_received{0};
+    std::chrono::system_clock::time_point capture_start;
+    size_t datagrams = 0;
+    size_t filtered = 0;
+    ReceiverStats stats;
+    SimulatedLink::Stats link_stats;
+    double replay_seconds = 0;
+
+    asio::io_context io_context;
+    asio::executor_work_guard<asio::io_context::executor_type> work(io_context.get_executor());
+    std::thread io_thread([&io_context]() { io_context.run(); });
+
+    try {
+        // Nothing else is bound to the link, so resend requests to the captured senders go nowhere
+        SimulatedLink link(io_context.get_executor());
+        SimulatedReceiver receiver(
+            std::make_unique<SimulatedSocket>(link, asio::ip::udp::endpoint(asio::ip::udp::v4(), 0)),
+            [&](FrameView frame) {
+                frames_received++;
+                bytes_received += frame.GetSize();
+                if (args.verbose) {
+                    // Arrival times are the captured ones
+                    std::cout << "frame " << std::setw(10) << frame.GetId()
+                              << std::setw(12) << frame.GetSize() << " bytes"
+                              << "  first chunk " << std::fixed << std::setprecision(3) << std::setw(12)
+                              << Milliseconds(frame.GetFirstChunkKernelTime() - capture_start) << " ms"
+                              << "  assembled in " << std::setw(9)
+                              << Milliseconds(frame.GetCompletedKernelTime() - frame.GetFirstChunkKernelTime()) << " ms"
+                              << std::endl;
+                }
+            },
+            args.mtu, args.buffer_size, args.max_data_size);
+        receiver.Start();
+
+        const std::chrono::steady_clock::time_point replay_start = std::chrono::steady_clock::now();
+        CaptureReader::Packet packet;
+        while (reader.Next(&packet)) {
+            if (args.port != 0 && packet.destination.port() != args.port) {
+                filtered++;
+                continue;
+            }
+            if (datagrams == 0) {
+                capture_start = packet.arrival;
+            }
+            if (!args.fast) {
+                const std::chrono::duration<double> offset = (packet.arrival - capture_start) / args.speed;
+                std::this_thread::sleep_until(
+                    replay_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+            }
+            while (!receiver.Inject(packet.source, packet.data.data(), packet.data.size(), packet.arrival)) {
+                std::this_thread::yield();
+            }
+            datagrams++;
+        }
+        // Injected datagrams are handled on the io thread; the replay ends with the last of them
+        while (receiver.GetStats().packets_received < datagrams) {
+            std::this_thread::yield();
+        }
+        replay_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count();
+
+        // Frames still assembling complete or time out
+        std::this_thread::sleep_for(DRAIN_TIME);
+        receiver.Stop();
+        stats = receiver.GetStats();
+        link_stats = link.GetStats();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        work.reset();
+        io_context.stop();
+        io_thread.join();
+        return 1;
+    }
+    work.reset();
+    io_context.stop();
+    io_thread.join();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Datagrams replayed:   " << datagrams << " in " << replay_seconds << " s" << std::endl;
+    std::cout << "Records skipped:      " << reader.GetSkippedCount() + filtered
+              << " (not UDP or truncated: " << reader.GetSkippedCount() << ", other ports: " << filtered << ")" << std::endl;
+    std::cout << "Frames completed:     " << frames_received << " (" << bytes_received << " bytes)" << std::endl;
+    std::cout << "Frames timed out:     " << stats.frames_timed_out << std::endl;
+    std::cout << "Frames abandoned:     " << stats.frames_abandoned << std::endl;
+    std::cout << "Malformed datagrams:  " << stats.malformed_packets << std::endl;
+    std::cout << "Duplicate chunks:     " << stats.duplicate_chunks << std::endl;
+    std::cout << "Late chunks:          " << stats.late_chunks << std::endl;
+    std::cout << "No buffer chunks:     " << stats.no_buffer_chunks << std::endl;
+    std::cout << "Resend requests:      " << stats.resend_requests_sent
+              << " (not sent: " << link_stats.unreachable << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,253 @@
+// Copyright (c) 2025 Wooseok Choi
+// Licensed under the MIT License - see LICENSE file
+
+// Renders per-frame timelines from a flight recorder dump (`FlightRecorder::Dump()`).
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "chunkstream/core/flight_recorder.h"
+
+using namespace chunkstream;
+
+// Command line argument parsing
+struct CommandLineArgs {
+    std::string path;
+    bool has_frame = false;
+    uint32_t frame = 0;
+    int stream = -1;       // Any stream
+    size_t slowest = 0;
+    bool dropped = false;
+    bool help = false;
+};
+
+// Events of one frame, from its creation (or the start of the dump) on
+struct Timeline {
+    uint8_t stream = 0;
+    uint32_t frame_id = 0;
+    bool partial = true;   // Created before the oldest event in the dump
+    std::vector<FlightRecorder::Event> events;
+};
+
+CommandLineArgs ParseArguments(int argc, char* argv[]) {
+    CommandLineArgs args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        try {
+            if (arg == "--help" || arg == "-h") {
+                args.help = true;
+            }
+            else if (arg == "--frame" && i + 1 < argc) {
+                args.has_frame = true;
+                args.frame = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--stream" && i + 1 < argc) {
+                args.stream = std::stoi(argv[++i]);
+            }
+            else if (arg == "--slowest" && i + 1 < argc) {
+                args.slowest = static_cast<size_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--dropped") {
+                args.dropped = true;
+            }
+            else if (args.path.empty() && arg[0] != '-') {
+                args.path = arg;
+            }
+            else {
+                std::cerr << "Error: Unknown argument: " << arg << std::endl;
+                args.help = true;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << std::endl;
+            args.help = true;
+        }
+    }
+    if (args.path.empty()) {
+        args.help = true;
+    }
+
+    return args;
+}
+
+void PrintUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " DUMP [OPTIONS]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Without options, prints one line per frame." << std::endl;
+    std::cout << std::endl;
+    std::cout << "OPTIONS:" << std::endl;
+    std::cout << "  --frame ID     Print the timeline of frame ID" << std::endl;
+    std::cout << "  --stream N     Only frames of stream N" << std::endl;
+    std::cout << "  --slowest N    Print the timelines of the N slowest frames" << std::endl;
+    std::cout << "  --dropped      Print the timelines of dropped frames" << std::endl;
+    std::cout << "  --help, -h     Show this help message" << std::endl;
+}
+
+const char* EventName(uint8_t type) {
+    switch (type) {
+        case FlightRecorder::FRAME_CREATED: return "created";
+        case FlightRecorder::FIRST_CHUNK: return "first chunk";
+        case FlightRecorder::LAST_CHUNK: return "last chunk";
+        case FlightRecorder::RESEND_ROUND: return "resend round";
+        case FlightRecorder::FRAME_READY: return "ready";
+        case FlightRecorder::FRAME_GRABBED: return "grabbed";
+        case FlightRecorder::FRAME_RELEASED: return "released";
+        case FlightRecorder::FRAME_DROPPED: return "dropped";
+        default: return "unknown";
+    }
+}
+
+std::vector<Timeline> BuildTimelines(const std::vector<FlightRecorder::Event>& events) {
+    std::vector<Timeline> timelines;
+    std::map<std::pair<uint8_t, uint32_t>, size_t> current; // Latest timeline of each frame
+
+    for (const FlightRecorder::Event& event : events) {
+        const std::pair<uint8_t, uint32_t> key(event.stream, event.frame_id);
+        auto it = current.find(key);
+        if (it == current.end() || event.type == FlightRecorder::FRAME_CREATED) {
+            Timeline timeline;
+            timeline.stream = event.stream;
+            timeline.frame_id = event.frame_id;
+            timeline.partial = event.type != FlightRecorder::FRAME_CREATED;
+            timelines.push_back(timeline);
+            it = current.insert_or_assign(key, timelines.size() - 1).first;
+        }
+        timelines[it->second].events.push_back(event);
+    }
+    return timelines;
+}
+
+// Ticks from the first event to the frame being ready or dropped, or to its last event
+uint64_t Duration(const Timeline& timeline) {
+    const uint64_t start = timeline.events.front().tsc;
+    for (const FlightRecorder::Event& event : timeline.events) {
+        if (event.type == FlightRecorder::FRAME_READY || event.type == FlightRecorder::FRAME_DROPPED) {
+            return event.tsc - start;
+        }
+    }
+    return timeline.events.back().tsc - start;
+}
+
+std::string Outcome(const Timeline& timeline) {
+    std::string outcome = "assembling";
+    for (const FlightRecorder::Event& event : timeline.events) {
+        if (event.type == FlightRecorder::FRAME_DROPPED) {
+            outcome = event.arg == 0 ? "dropped (timed out)" : "dropped (abandoned)";
+        } else if (event.type == FlightRecorder::FRAME_READY) {
+            outcome = "ready";
+        } else if (event.type == FlightRecorder::FRAME_GRABBED) {
+            outcome = "grabbed";
+        } else if (event.type == FlightRecorder::FRAME_RELEASED) {
+            outcome = "released";
+        }
+    }
+    return timeline.partial ? outcome + ", partial" : outcome;
+}
+
+size_t ResendRounds(const Timeline& timeline) {
+    return static_cast<size_t>(std::count_if(timeline.events.begin(), timeline.events.end(),
+        [](const FlightRecorder::Event& event) { return event.type == FlightRecorder::RESEND_ROUND; }));
+}
+
+bool IsDropped(const Timeline& timeline) {
+    return std::any_of(timeline.events.begin(), timeline.events.end(),
+        [](const FlightRecorder::Event& event) { return event.type == FlightRecorder::FRAME_DROPPED; });
+}
+
+void PrintTimeline(const Timeline& timeline, double ms_per_tick) {
+    std::cout << "frame " << timeline.frame_id << " (stream " << static_cast<int>(timeline.stream) << "): "
+              << Outcome(timeline) << " after " << std::fixed << std::setprecision(3)
+              << Duration(timeline) * ms_per_tick << " ms, "
+              << ResendRounds(timeline) << " resend rounds" << std::endl;
+
+    const uint64_t start = timeline.events.front().tsc;
+    for (const FlightRecorder::Event& event : timeline.events) {
+        std::cout << "  +" << std::setw(10) << (event.tsc - start) * ms_per_tick << " ms  "
+                  << std::left << std::setw(14) << EventName(event.type) << std::right;
+        switch (event.type) {
+            case FlightRecorder::FRAME_CREATED: std::cout << event.arg << " chunks"; break;
+            case FlightRecorder::FIRST_CHUNK:
+            case FlightRecorder::LAST_CHUNK: std::cout << "#" << event.arg; break;
+            case FlightRecorder::RESEND_ROUND: std::cout << "round " << event.arg; break;
+            default: break;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    CommandLineArgs args = ParseArguments(argc, argv);
+    if (args.help) {
+        PrintUsage(argv[0]);
+        return args.path.empty() ? 1 : 0;
+    }
+
+    FlightRecorder::FileHeader header;
+    std::vector<FlightRecorder::Event> events;
+    if (!FlightRecorder::Load(args.path, &header, &events)) {
+        return 1;
+    }
+    if (events.empty()) {
+        std::cout << "No events" << std::endl;
+        return 0;
+    }
+    const double ms_per_tick = header.ticks_per_second > 0 ? 1000.0 / header.ticks_per_second : 0;
+
+    std::vector<Timeline> timelines = BuildTimelines(events);
+    if (args.stream >= 0) {
+        timelines.erase(std::remove_if(timelines.begin(), timelines.end(),
+            [&args](const Timeline& timeline) { return timeline.stream != args.stream; }), timelines.end());
+    }
+
+    std::cout << events.size() << " events, " << timelines.size() << " frames over "
+              << std::fixed << std::setprecision(3)
+              << (events.back().tsc - events.front().tsc) * ms_per_tick << " ms" << std::endl << std::endl;
+
+    if (args.has_frame) {
+        for (const Timeline& timeline : timelines) {
+            if (timeline.frame_id == args.frame) {
+                PrintTimeline(timeline, ms_per_tick);
+            }
+        }
+        return 0;
+    }
+
+    if (args.slowest > 0 || args.dropped) {
+        std::vector<const Timeline*> selected;
+        for (const Timeline& timeline : timelines) {
+            if (!args.dropped || IsDropped(timeline)) {
+                selected.push_back(&timeline);
+            }
+        }
+        if (args.slowest > 0) {
+            std::sort(selected.begin(), selected.end(), [](const Timeline* a, const Timeline* b) {
+                return Duration(*a) > Duration(*b);
+            });
+            selected.resize(std::min(selected.size(), args.slowest));
+        }
+        for (const Timeline* timeline : selected) {
+            PrintTimeline(*timeline, ms_per_tick);
+        }
+        return 0;
+    }
+
+    std::cout << std::setw(6) << "stream" << std::setw(12) << "frame" << std::setw(12) << "start_ms"
+              << std::setw(13) << "duration_ms" << std::setw(9) << "resends" << "  outcome" << std::endl;
+    for (const Timeline& timeline : timelines) {
+        std::cout << std::setw(6) << static_cast<int>(timeline.stream)
+                  << std::setw(12) << timeline.frame_id
+                  << std::setw(12) << (timeline.events.front().tsc - events.front().tsc) * ms_per_tick
+                  << std::setw(13) << Duration(timeline) * ms_per_tick
+                  << std::setw(9) << ResendRounds(timeline)
+                  << "  " << Outcome(timeline) << std::endl;
+    }
+    return 0;
+}